@@ -0,0 +1,441 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consolebench.h"
+#include "consolemodel.h"
+#include "consoleingester.h"
+#include "serverprocess.h"
+#include "processmemory.h"
+
+#include <QListView>
+#include <QScrollBar>
+#include <QFileInfo>
+
+#include <chrono>
+
+// the GUI thread counts as stalled when a probe fires this much late
+#define PROBE_INTERVAL 5
+#define STALL_THRESHOLD 5
+
+// after the server exited, a scenario ends when no line came for this long
+#define COMPLETE_TIMEOUT 2000
+
+static qint64 microseconds()
+{
+    using namespace std::chrono;
+    return duration_cast<std::chrono::microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// "... #<sequence>@<usecs> xxxx", as written by the fake server
+static bool parseMarker(const QString& text, qint64& sequence, qint64& written)
+{
+    int hash = text.lastIndexOf(QLatin1Char('#'));
+    int at = text.indexOf(QLatin1Char('@'), hash);
+    if(hash < 0 || at < 0)
+        return false;
+
+    int end = text.indexOf(QLatin1Char(' '), at);
+    if(end < 0)
+        end = text.size();
+
+    bool sequenceOk, writtenOk;
+    sequence = text.midRef(hash + 1, at - hash - 1).toLongLong(&sequenceOk);
+    written = text.midRef(at + 1, end - at - 1).toLongLong(&writtenOk);
+
+    return sequenceOk && writtenOk;
+}
+
+ConsoleBench::ConsoleBench(const QString &serverPath, QObject *parent) :
+    QObject(parent),
+    m_serverPath(serverPath),
+    m_out(stdout)
+{
+    m_flushRate = 20;
+    m_scrollback = 50000;
+    m_showView = true;
+    m_mergedChannels = false;
+    m_csv = false;
+    m_exitCode = 0;
+
+    m_pView = 0;
+    m_pModel = new ConsoleModel(this);
+
+    m_pServerProcess = new ServerProcess;
+    m_pServerProcess->moveToThread(&m_serverThread);
+
+    connect( &m_serverThread, SIGNAL(finished()), m_pServerProcess, SLOT(deleteLater()) );
+    connect( m_pServerProcess, SIGNAL(started()), SLOT(onStarted()) );
+    connect( m_pServerProcess, SIGNAL(startFailed()), SLOT(onStartFailed()) );
+    connect( m_pServerProcess, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onFinished(int,QProcess::ExitStatus)) );
+    connect( m_pServerProcess->ingester(), SIGNAL(linesAvailable()), SLOT(onLinesAvailable()) );
+
+    m_drainTimer.setSingleShot(true);
+    connect( &m_drainTimer, SIGNAL(timeout()), SLOT(drain()) );
+
+    m_probeTimer.setTimerType(Qt::PreciseTimer);
+    m_probeTimer.setInterval(PROBE_INTERVAL);
+    connect( &m_probeTimer, SIGNAL(timeout()), SLOT(probe()) );
+
+    m_completeTimer.setInterval(100);
+    connect( &m_completeTimer, SIGNAL(timeout()), SLOT(checkComplete()) );
+
+    m_lastLineTime = 0;
+    m_lastProgress = 0;
+    m_received = 0;
+    m_bytes = 0;
+    m_outOfOrder = 0;
+    m_lastSequence = -1;
+    m_processFinished = false;
+    m_maxStall = 0;
+    m_totalStall = 0;
+}
+
+ConsoleBench::~ConsoleBench()
+{
+    if(m_serverThread.isRunning())
+    {
+        QMetaObject::invokeMethod(m_pServerProcess, "waitForFinished", Qt::BlockingQueuedConnection);
+        m_serverThread.quit();
+        m_serverThread.wait();
+    }
+
+    delete m_pView;
+}
+
+void ConsoleBench::start()
+{
+    m_pModel->setCapacity(m_scrollback);
+
+    if(m_showView)
+    {
+        m_pView = new QListView;
+        m_pView->setUniformItemSizes(true);
+        m_pView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+        m_pView->setModel(m_pModel);
+        m_pView->setWindowTitle("consolebench");
+        m_pView->resize(800, 600);
+        m_pView->show();
+    }
+
+    m_serverThread.start();
+    m_sinceDrain.start();
+
+    QMetaObject::invokeMethod(m_pServerProcess, "setMergedChannels", Qt::QueuedConnection,
+                              Q_ARG(bool, m_mergedChannels));
+
+    if(!m_journalDirectory.isEmpty())
+    {
+        // nothing is restored, every run starts from an empty console
+        QMetaObject::invokeMethod(m_pServerProcess, "openJournal", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_journalDirectory),
+                                  Q_ARG(int, 16),
+                                  Q_ARG(int, 4),
+                                  Q_ARG(int, 0),
+                                  Q_ARG(int, 0));
+    }
+
+    printHeader();
+    QTimer::singleShot(0, this, SLOT(runNext()));
+}
+
+bool ConsoleBench::checkOverflow()
+{
+    // more than the queue and its overflow hold together
+    const int lines = 200000;
+
+    ConsoleIngester ingester;
+
+    for(int i = 0; i < lines; i++)
+    {
+        ingester.feed(ConsoleIngester::StandardOutput, QString("[Server thread/INFO]: overflow #%1\n").arg(i).toUtf8());
+    }
+
+    ConsoleBuffer buffer(lines);
+    QVector<ConsoleLine> drained;
+    int notices = 0;
+    bool ordered = true;
+
+    forever
+    {
+        // moves the overflow on into the queue
+        ingester.finish();
+
+        drained.clear();
+        if(ingester.drain(drained, lines) == 0)
+            break;
+
+        foreach(const ConsoleLine& line, drained)
+        {
+            if(!buffer.isEmpty() && line.sequence < buffer.nextSequence())
+            {
+                ordered = false;
+                continue;
+            }
+
+            if(line.event.channel == LogEvent::ChannelApplication)
+                notices++;
+
+            buffer.append(line);
+        }
+    }
+
+    // a client that got everything before the dropped lines, resuming in
+    // batches like RemoteSession::pushLines
+    quint64 from = 0;
+    for(int i = 1; i < buffer.size(); i++)
+    {
+        if(buffer.at(i).sequence != buffer.at(i - 1).sequence + 1)
+        {
+            from = buffer.at(i - 1).sequence + 1;
+            break;
+        }
+    }
+
+    int expected = buffer.size() - buffer.indexOf(from);
+    int received = 0;
+    bool resumed = true;
+    quint64 last = from;
+
+    while(from < buffer.nextSequence())
+    {
+        int first = buffer.indexOf(from);
+        int count = qMin(buffer.size() - first, 1000);
+
+        for(int i = first; i < first + count; i++)
+        {
+            if(buffer.at(i).sequence < last)
+                resumed = false;
+
+            last = buffer.at(i).sequence + 1;
+            received++;
+        }
+
+        from = buffer.at(first + count - 1).sequence + 1;
+    }
+
+    bool ok = ordered && notices > 0 && resumed && received == expected;
+
+    m_out << "overflow: " << buffer.size() << " of " << lines << " lines kept, "
+          << notices << " notices, resumed " << received << " of " << expected << " lines, "
+          << (ok ? "ok" : "FAILED") << Qt::endl;
+
+    return ok;
+}
+
+void ConsoleBench::runNext()
+{
+    if(m_scenarios.isEmpty())
+    {
+        emit done();
+        return;
+    }
+
+    m_scenario = m_scenarios.takeFirst();
+
+    m_pModel->clear();
+    m_latency.clear();
+    m_lastLineTime = 0;
+    m_lastProgress = 0;
+    m_received = 0;
+    m_bytes = 0;
+    m_outOfOrder = 0;
+    m_lastSequence = -1;
+    m_processFinished = false;
+    m_maxStall = 0;
+    m_totalStall = 0;
+
+    QStringList arguments;
+    arguments << "--lines" << QString::number(m_scenario.lines)
+              << "--rate" << QString::number(m_scenario.rate)
+              << "--length" << QString::number(m_scenario.length)
+              << "--burst" << QString::number(m_scenario.burst)
+              << "--stderr-every" << QString::number(m_scenario.stderrEvery);
+
+    m_elapsed.start();
+    m_sinceProbe.start();
+    m_probeTimer.start();
+
+    QMetaObject::invokeMethod(m_pServerProcess, "start", Qt::QueuedConnection,
+                              Q_ARG(QString, m_serverPath),
+                              Q_ARG(QStringList, arguments),
+                              Q_ARG(QString, QFileInfo(m_serverPath).absolutePath()));
+}
+
+void ConsoleBench::onStarted()
+{
+    // process creation is not part of the pipeline
+    m_elapsed.restart();
+}
+
+void ConsoleBench::onStartFailed()
+{
+    m_probeTimer.stop();
+
+    QTextStream(stderr) << "Unable to start " << m_serverPath << Qt::endl;
+
+    m_exitCode = 1;
+    emit done();
+}
+
+void ConsoleBench::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitCode);
+    Q_UNUSED(exitStatus);
+
+    m_processFinished = true;
+    m_lastProgress = m_elapsed.elapsed();
+    m_completeTimer.start();
+
+    drain();
+}
+
+void ConsoleBench::onLinesAvailable()
+{
+    if(m_drainTimer.isActive())
+        return;
+
+    // same pacing as ServerController::onConsoleLinesAvailable()
+    int interval = 1000 / qBound(1, m_flushRate, 1000);
+    qint64 elapsed = m_sinceDrain.elapsed();
+
+    m_drainTimer.start(elapsed >= interval ? 0 : int(interval - elapsed));
+}
+
+void ConsoleBench::drain()
+{
+    m_drainTimer.stop();
+    m_sinceDrain.restart();
+
+    QVector<ConsoleLine> lines;
+    int maxLines = m_pModel->buffer().capacity();
+
+    if(m_pServerProcess->ingester()->drain(lines, maxLines) == maxLines)
+        onLinesAvailable();
+
+    if(lines.isEmpty())
+        return;
+
+    bool atBottom = !m_pView || m_pView->verticalScrollBar()->value() == m_pView->verticalScrollBar()->maximum();
+
+    m_pModel->appendLines(lines);
+
+    if(m_pView && atBottom)
+        m_pView->scrollToBottom();
+
+    record(lines, microseconds());
+}
+
+void ConsoleBench::probe()
+{
+    qint64 late = m_sinceProbe.restart() - PROBE_INTERVAL;
+
+    if(late > STALL_THRESHOLD)
+    {
+        m_totalStall += late;
+        m_maxStall = qMax(m_maxStall, late);
+    }
+}
+
+void ConsoleBench::checkComplete()
+{
+    if(!m_processFinished)
+        return;
+
+    if(m_received >= m_scenario.lines || m_elapsed.elapsed() - m_lastProgress > COMPLETE_TIMEOUT)
+        complete();
+}
+
+void ConsoleBench::record(const QVector<ConsoleLine> &lines, qint64 now)
+{
+    foreach(const ConsoleLine& line, lines)
+    {
+        qint64 sequence, written;
+
+        if(!parseMarker(line.text, sequence, written))
+            continue;
+
+        if(sequence < m_lastSequence)
+            m_outOfOrder++;
+
+        m_lastSequence = qMax(m_lastSequence, sequence);
+        m_received++;
+        m_bytes += line.text.size() + 1;
+        m_latency.add(now - written);
+    }
+
+    m_lastLineTime = m_elapsed.elapsed();
+    m_lastProgress = m_lastLineTime;
+}
+
+void ConsoleBench::complete()
+{
+    m_completeTimer.stop();
+    m_probeTimer.stop();
+
+    double seconds = qMax(qint64(1), m_lastLineTime) / 1000.0;
+    QStringList row;
+
+    row << m_scenario.name
+        << QString::number(m_received)
+        << QString::number(m_scenario.lines - m_received)
+        << QString::number(m_outOfOrder)
+        << QString::number(m_received / seconds, 'f', 0)
+        << QString::number(m_bytes / seconds / (1024 * 1024), 'f', 2)
+        << QString::number(m_latency.percentile(0.50) / 1000.0, 'f', 2)
+        << QString::number(m_latency.percentile(0.99) / 1000.0, 'f', 2)
+        << QString::number(m_latency.max() / 1000.0, 'f', 2)
+        << QString::number(m_maxStall)
+        << QString::number(m_totalStall)
+        << QString::number(ProcessMemory::residentKB() / 1024.0, 'f', 1)
+        << QString::number(ProcessMemory::peakResidentKB() / 1024.0, 'f', 1);
+
+    if(m_csv)
+    {
+        m_out << row.join(",") << Qt::endl;
+    }
+    else
+    {
+        m_out << row.at(0).leftJustified(14);
+        for(int i = 1; i < row.size(); i++)
+        {
+            m_out << row.at(i).rightJustified(10);
+        }
+        m_out << Qt::endl;
+    }
+
+    QTimer::singleShot(0, this, SLOT(runNext()));
+}
+
+void ConsoleBench::printHeader()
+{
+    QStringList header;
+    header << "scenario" << "lines" << "lost" << "reorder" << "lines/s" << "MB/s"
+           << "p50 ms" << "p99 ms" << "max ms" << "stall ms" << "stalled" << "RSS MB" << "peak MB";
+
+    if(m_csv)
+    {
+        m_out << header.join(",") << Qt::endl;
+        return;
+    }
+
+    m_out << header.at(0).leftJustified(14);
+    for(int i = 1; i < header.size(); i++)
+    {
+        m_out << header.at(i).rightJustified(10);
+    }
+    m_out << Qt::endl;
+}
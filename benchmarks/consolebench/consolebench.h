@@ -0,0 +1,131 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLEBENCH_H
+#define CONSOLEBENCH_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QList>
+#include <QTextStream>
+
+#include "consolebuffer.h"
+#include "latencyhistogram.h"
+
+class ConsoleModel;
+class ServerProcess;
+class QListView;
+
+struct BenchScenario
+{
+    QString name;
+    int lines;
+    int rate;           // lines per second, 0 for as fast as possible
+    int length;
+    int burst;
+    int stderrEvery;
+};
+
+// Runs the fake server through the same pipeline the main window uses:
+// ServerProcess on its own thread, rate-limited drains into the
+// ConsoleModel and a QListView, and reports what it measured.
+class ConsoleBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConsoleBench(const QString& serverPath, QObject *parent = 0);
+    ~ConsoleBench();
+
+    void setFlushRate(int flushRate) {m_flushRate = flushRate;}
+    void setScrollback(int scrollback) {m_scrollback = scrollback;}
+    void setJournalDirectory(const QString& directory) {m_journalDirectory = directory;}
+    void setShowView(bool showView) {m_showView = showView;}
+    void setMergedChannels(bool merged) {m_mergedChannels = merged;}
+    void setCsv(bool csv) {m_csv = csv;}
+
+    void addScenario(const BenchScenario& scenario) {m_scenarios.append(scenario);}
+
+    void start();
+
+    // overflows an undrained ingester, then resumes a client the way the
+    // remote server does, true when no line is lost or repeated
+    bool checkOverflow();
+
+    int exitCode() const {return m_exitCode;}
+
+signals:
+    void done();
+
+private slots:
+    void runNext();
+    void onStarted();
+    void onStartFailed();
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onLinesAvailable();
+    void drain();
+    void probe();
+    void checkComplete();
+
+private:
+    void record(const QVector<ConsoleLine>& lines, qint64 now);
+    void complete();
+    void printHeader();
+
+    QString m_serverPath;
+    int m_flushRate;
+    int m_scrollback;
+    QString m_journalDirectory;
+    bool m_showView;
+    bool m_mergedChannels;
+    bool m_csv;
+    int m_exitCode;
+
+    QList<BenchScenario> m_scenarios;
+    BenchScenario m_scenario;
+
+    QThread m_serverThread;
+    ServerProcess* m_pServerProcess;
+    ConsoleModel* m_pModel;
+    QListView* m_pView;
+
+    QTimer m_drainTimer;
+    QElapsedTimer m_sinceDrain;
+    QTimer m_probeTimer;
+    QElapsedTimer m_sinceProbe;
+    QTimer m_completeTimer;
+
+    // per scenario
+    QElapsedTimer m_elapsed;
+    qint64 m_lastLineTime;
+    qint64 m_lastProgress;
+    qint64 m_received;
+    qint64 m_bytes;
+    qint64 m_outOfOrder;
+    qint64 m_lastSequence;
+    bool m_processFinished;
+    LatencyHistogram m_latency;
+    qint64 m_maxStall;
+    qint64 m_totalStall;
+
+    QTextStream m_out;
+};
+
+#endif // CONSOLEBENCH_H
@@ -0,0 +1,33 @@
+#-------------------------------------------------
+# Qt Minecraft Server
+# Copyleft 2013
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = consolebench
+TEMPLATE = app
+
+include(../benchmarks.pri)
+include(../../console.pri)
+include(../../consoleview.pri)
+
+SOURCES += main.cpp \
+    consolebench.cpp
+
+HEADERS += consolebench.h
@@ -0,0 +1,116 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Console ingestion benchmark: throughput, end-to-end line latency,
+// GUI thread stalls and resident memory, for the built-in scenarios or
+// a single one described on the command line. Run it with
+// "-platform offscreen" on machines without a display.
+
+#include "consolebench.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+
+static BenchScenario scenario(const char* name, int lines, int rate, int length, int burst, int stderrEvery)
+{
+    BenchScenario scenario;
+    scenario.name = name;
+    scenario.lines = lines;
+    scenario.rate = rate;
+    scenario.length = length;
+    scenario.burst = burst;
+    scenario.stderrEvery = stderrEvery;
+    return scenario;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Console ingestion benchmark");
+    parser.addHelpOption();
+
+    QCommandLineOption serverOption("server", "Fake server executable.", "path",
+                                    QCoreApplication::applicationDirPath() + "/fakeserver");
+    QCommandLineOption linesOption("lines", "Lines per run.", "count");
+    QCommandLineOption rateOption("rate", "Lines per second, 0 for as fast as possible.", "lines");
+    QCommandLineOption lengthOption("length", "Line length in bytes.", "bytes");
+    QCommandLineOption burstOption("burst", "Lines written back to back.", "lines");
+    QCommandLineOption stderrOption("stderr-every", "Every n-th line goes to stderr.", "n");
+    QCommandLineOption flushRateOption("flush-rate", "View updates per second.", "rate", "20");
+    QCommandLineOption scrollbackOption("scrollback", "Scrollback lines.", "lines", "50000");
+    QCommandLineOption journalOption("journal", "Also write the console journal to this directory.", "directory");
+    QCommandLineOption mergedOption("merged", "Merge stdout and stderr at the process.");
+    QCommandLineOption noViewOption("no-view", "Feed the model without a view.");
+    QCommandLineOption csvOption("csv", "Print comma separated values.");
+    QCommandLineOption checkOverflowOption("check-overflow", "Overflow the console queue, resume a client and check no line went missing.");
+
+    parser.addOption(serverOption);
+    parser.addOption(linesOption);
+    parser.addOption(rateOption);
+    parser.addOption(lengthOption);
+    parser.addOption(burstOption);
+    parser.addOption(stderrOption);
+    parser.addOption(flushRateOption);
+    parser.addOption(scrollbackOption);
+    parser.addOption(journalOption);
+    parser.addOption(mergedOption);
+    parser.addOption(noViewOption);
+    parser.addOption(csvOption);
+    parser.addOption(checkOverflowOption);
+    parser.process(app);
+
+    ConsoleBench bench(parser.value(serverOption));
+    bench.setFlushRate(parser.value(flushRateOption).toInt());
+    bench.setScrollback(parser.value(scrollbackOption).toInt());
+    bench.setJournalDirectory(parser.value(journalOption));
+    bench.setMergedChannels(parser.isSet(mergedOption));
+    bench.setShowView(!parser.isSet(noViewOption));
+    bench.setCsv(parser.isSet(csvOption));
+
+    if(parser.isSet(checkOverflowOption))
+        return bench.checkOverflow() ? 0 : 1;
+
+    if(parser.isSet(linesOption) || parser.isSet(rateOption) || parser.isSet(lengthOption) ||
+       parser.isSet(burstOption) || parser.isSet(stderrOption))
+    {
+        bench.addScenario(scenario("custom",
+                                   parser.isSet(linesOption) ? parser.value(linesOption).toInt() : 100000,
+                                   parser.value(rateOption).toInt(),
+                                   parser.isSet(lengthOption) ? parser.value(lengthOption).toInt() : 120,
+                                   parser.isSet(burstOption) ? parser.value(burstOption).toInt() : 1,
+                                   parser.value(stderrOption).toInt()));
+    }
+    else
+    {
+        bench.addScenario(scenario("steady", 50000, 10000, 120, 10, 0));
+        bench.addScenario(scenario("flood", 500000, 0, 100, 1000, 0));
+        bench.addScenario(scenario("long-lines", 100000, 0, 2000, 100, 0));
+        bench.addScenario(scenario("bursts", 200000, 20000, 120, 5000, 0));
+        bench.addScenario(scenario("stderr-mix", 200000, 0, 120, 100, 10));
+    }
+
+    QObject::connect(&bench, SIGNAL(done()), &app, SLOT(quit()));
+
+    bench.start();
+    app.exec();
+
+    return bench.exitCode();
+}
@@ -0,0 +1,116 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Stands in for the Minecraft server: writes numbered console lines at
+// a given rate through stdout and stderr, so the real QProcess capture
+// path can be measured. Every line carries "#<sequence>@<usecs>", the
+// wall clock time it was written, for the end-to-end latency.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+
+#include <stdio.h>
+#include <chrono>
+
+static qint64 microseconds()
+{
+    using namespace std::chrono;
+    return duration_cast<std::chrono::microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static qint64 steadyMicroseconds()
+{
+    using namespace std::chrono;
+    return duration_cast<std::chrono::microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static int intOption(const QCommandLineParser& parser, const QString& name, int minimum)
+{
+    return qMax(minimum, parser.value(name).toInt());
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic Minecraft server console output");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("lines", "Number of lines to write.", "count", "100000"));
+    parser.addOption(QCommandLineOption("rate", "Lines per second, 0 writes as fast as possible.", "lines", "0"));
+    parser.addOption(QCommandLineOption("length", "Length of every line in bytes.", "bytes", "120"));
+    parser.addOption(QCommandLineOption("burst", "Lines written back to back before flushing.", "lines", "1"));
+    parser.addOption(QCommandLineOption("stderr-every", "Every n-th line goes to stderr, 0 for none.", "n", "0"));
+    parser.process(app);
+
+    int lines = intOption(parser, "lines", 0);
+    int rate = intOption(parser, "rate", 0);
+    int length = intOption(parser, "length", 64);
+    int burst = intOption(parser, "burst", 1);
+    int stderrEvery = intOption(parser, "stderr-every", 0);
+
+    static char stdoutBuffer[1 << 20];
+    static char stderrBuffer[1 << 20];
+    setvbuf(stdout, stdoutBuffer, _IOFBF, sizeof(stdoutBuffer));
+    setvbuf(stderr, stderrBuffer, _IOFBF, sizeof(stderrBuffer));
+
+    QByteArray padding(length, 'x');
+    qint64 start = steadyMicroseconds();
+
+    for(int sequence = 0; sequence < lines; )
+    {
+        for(int i = 0; i < burst && sequence < lines; i++, sequence++)
+        {
+            bool error = (stderrEvery > 0) && (sequence % stderrEvery == stderrEvery - 1);
+            char head[128];
+            int size;
+
+            if(error)
+            {
+                // looks like a stack trace line, which has no prefix
+                size = snprintf(head, sizeof(head), "\tat bench.Frame.run(Frame.java:%d) #%d@%lld ",
+                                sequence % 1000, sequence, microseconds());
+            }
+            else
+            {
+                size = snprintf(head, sizeof(head), "[12:00:00] [Server thread/INFO]: #%d@%lld ",
+                                sequence, microseconds());
+            }
+
+            FILE* out = error ? stderr : stdout;
+            fwrite(head, 1, size, out);
+            fwrite(padding.constData(), 1, qMax(0, length - size), out);
+            fputc('\n', out);
+        }
+
+        fflush(stdout);
+        fflush(stderr);
+
+        if(rate > 0)
+        {
+            // keep to the schedule instead of sleeping a fixed time per burst
+            qint64 due = start + qint64(sequence) * 1000000 / rate;
+            qint64 now = steadyMicroseconds();
+
+            if(due > now)
+                QThread::usleep((unsigned long)(due - now));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QVector>
+
+// Log-linear histogram of microsecond values: 16 buckets per power of
+// two, so percentiles are within about 6% without storing samples.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() :
+        m_buckets(BUCKET_COUNT, 0),
+        m_count(0),
+        m_max(0)
+    {
+    }
+
+    void add(qint64 value)
+    {
+        value = qMax(qint64(0), value);
+
+        m_buckets[bucket(value)]++;
+        m_count++;
+        m_max = qMax(m_max, value);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for(int i = 0; i < BUCKET_COUNT; i++)
+        {
+            m_buckets[i] += other.m_buckets.at(i);
+        }
+
+        m_count += other.m_count;
+        m_max = qMax(m_max, other.m_max);
+    }
+
+    void clear()
+    {
+        m_buckets.fill(0);
+        m_count = 0;
+        m_max = 0;
+    }
+
+    qint64 count() const {return m_count;}
+    qint64 max() const {return m_max;}
+
+    // lower bound of the bucket holding the given fraction, 0.99 for p99
+    qint64 percentile(double fraction) const
+    {
+        if(m_count == 0)
+            return 0;
+
+        qint64 rank = qMax(qint64(1), qint64(fraction * m_count + 0.5));
+        qint64 seen = 0;
+
+        for(int i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += m_buckets.at(i);
+            if(seen >= rank)
+                return qMin(lowerBound(i), m_max);
+        }
+
+        return m_max;
+    }
+
+private:
+    enum
+    {
+        SUB_BITS = 4,
+        SUB_COUNT = 1 << SUB_BITS,
+        BUCKET_COUNT = (64 - SUB_BITS + 1) * SUB_COUNT
+    };
+
+    static int bucket(qint64 value)
+    {
+        if(value < SUB_COUNT)
+            return int(value);
+
+        int exponent = 63;
+        while(!(quint64(value) >> exponent))
+            exponent--;
+
+        int sub = int(value >> (exponent - SUB_BITS)) & (SUB_COUNT - 1);
+        return (exponent - SUB_BITS + 1) * SUB_COUNT + sub;
+    }
+
+    static qint64 lowerBound(int bucket)
+    {
+        if(bucket < SUB_COUNT)
+            return bucket;
+
+        int exponent = bucket / SUB_COUNT + SUB_BITS - 1;
+        int sub = bucket % SUB_COUNT;
+
+        return (qint64(SUB_COUNT + sub)) << (exponent - SUB_BITS);
+    }
+
+    QVector<qint64> m_buckets;
+    qint64 m_count;
+    qint64 m_max;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,82 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROCESSMEMORY_H
+#define PROCESSMEMORY_H
+
+#include <QtGlobal>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_LINUX)
+#include <QFile>
+#endif
+
+// Resident memory of this process in KB, -1 where it is not known.
+namespace ProcessMemory
+{
+
+#if defined(Q_OS_LINUX)
+inline qint64 statusValue(const char* key)
+{
+    QFile file("/proc/self/status");
+    if(!file.open(QIODevice::ReadOnly))
+        return -1;
+
+    // "VmRSS:     12345 kB"
+    foreach(const QByteArray& line, file.readAll().split('\n'))
+    {
+        if(line.startsWith(key))
+            return line.mid(qstrlen(key)).simplified().split(' ').value(0).toLongLong();
+    }
+
+    return -1;
+}
+#endif
+
+inline qint64 residentKB()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.WorkingSetSize / 1024);
+    return -1;
+#elif defined(Q_OS_LINUX)
+    return statusValue("VmRSS:");
+#else
+    return -1;
+#endif
+}
+
+inline qint64 peakResidentKB()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize / 1024);
+    return -1;
+#elif defined(Q_OS_LINUX)
+    return statusValue("VmHWM:");
+#else
+    return -1;
+#endif
+}
+
+}
+
+#endif // PROCESSMEMORY_H
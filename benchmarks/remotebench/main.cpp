@@ -0,0 +1,149 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Remote protocol load test: many authenticated connections firing a
+// weighted mix of command, mcServerStatus, mcLogsUpdate and file
+// requests at a running qtmcserver, reporting throughput and latency
+// percentiles per request class. Needs no display.
+
+#include "remotebench.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+// "command=1,status=4,update=4,file=1"
+static bool parseMix(const QString& text, RemoteBench& bench)
+{
+    int total = 0;
+
+    foreach(const QString& part, text.split(',', Qt::SkipEmptyParts))
+    {
+        QStringList pair = part.split('=');
+        int requestClass = BenchClassCount;
+
+        for(int i = 0; i < BenchClassCount; i++)
+        {
+            if(RemoteBench::className(i) == pair.value(0).trimmed())
+                requestClass = i;
+        }
+
+        bool ok;
+        int weight = pair.value(1).toInt(&ok);
+
+        if(pair.size() != 2 || requestClass == BenchClassCount || !ok || weight < 0)
+            return false;
+
+        bench.setWeight(requestClass, weight);
+        total += weight;
+    }
+
+    return total > 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Remote protocol load test");
+    parser.addHelpOption();
+
+    QCommandLineOption hostOption("host", "Server address.", "host", "127.0.0.1");
+    QCommandLineOption portOption("port", "Remote control port.", "port", "7777");
+    QCommandLineOption keyOption("key", "Connection key as shown on the remote tab.", "key");
+    QCommandLineOption keyTimeOption("key-time", "Minute the key was refreshed, yyyy/MM/dd-HH:mm, instead of --key. "
+                                                 "The current minute when neither is given.", "minute");
+    QCommandLineOption connectionsOption("connections", "Connections, the server refuses more than 64.", "count", "16");
+    QCommandLineOption pipelineOption("pipeline", "Requests in flight per connection.", "count", "1");
+    QCommandLineOption requestsOption("requests", "Requests in total, 0 for no limit.", "count", "20000");
+    QCommandLineOption durationOption("duration", "Stop issuing requests after this many seconds.", "seconds", "0");
+    QCommandLineOption mixOption("mix", "Request weights of command, status, update and file.", "weights",
+                                 "command=1,status=4,update=4,file=1");
+    QCommandLineOption commandOption("command", "Console command to send, the default one is dropped by the server.",
+                                     "text", "texttest");
+    QCommandLineOption fileLengthOption("file-length", "Bytes of latest.log per file request, -1 for all.", "bytes", "65536");
+    QCommandLineOption deflateOption("deflate", "Ask for compressed payloads.");
+    QCommandLineOption seedOption("seed", "Seed of the request mix.", "seed", "1");
+    QCommandLineOption csvOption("csv", "Print comma separated values.");
+
+    parser.addOption(hostOption);
+    parser.addOption(portOption);
+    parser.addOption(keyOption);
+    parser.addOption(keyTimeOption);
+    parser.addOption(connectionsOption);
+    parser.addOption(pipelineOption);
+    parser.addOption(requestsOption);
+    parser.addOption(durationOption);
+    parser.addOption(mixOption);
+    parser.addOption(commandOption);
+    parser.addOption(fileLengthOption);
+    parser.addOption(deflateOption);
+    parser.addOption(seedOption);
+    parser.addOption(csvOption);
+    parser.process(app);
+
+    RemoteBench bench;
+
+    if(!parseMix(parser.value(mixOption), bench))
+    {
+        QTextStream(stderr) << "Invalid request mix " << parser.value(mixOption) << Qt::endl;
+        return 2;
+    }
+
+    if(parser.isSet(keyOption))
+    {
+        bench.setKey(parser.value(keyOption).toLatin1());
+    }
+    else
+    {
+        QDateTime minute = parser.isSet(keyTimeOption) ?
+                    QDateTime::fromString(parser.value(keyTimeOption), "yyyy/MM/dd-HH:mm") :
+                    QDateTime::currentDateTime();
+
+        if(!minute.isValid())
+        {
+            QTextStream(stderr) << "Invalid key time " << parser.value(keyTimeOption) << Qt::endl;
+            return 2;
+        }
+
+        bench.setKey(connectionKey(minute));
+    }
+
+    bench.setServer(parser.value(hostOption), quint16(parser.value(portOption).toUInt()));
+    bench.setConnections(qMax(1, parser.value(connectionsOption).toInt()));
+    bench.setPipeline(qMax(1, parser.value(pipelineOption).toInt()));
+    bench.setRequests(qMax(qint64(0), parser.value(requestsOption).toLongLong()));
+    bench.setDuration(qMax(0, parser.value(durationOption).toInt()));
+    bench.setCommand(parser.value(commandOption));
+    bench.setFileLength(parser.value(fileLengthOption).toLongLong());
+    bench.setDeflate(parser.isSet(deflateOption));
+    bench.setSeed(parser.value(seedOption).toUInt());
+    bench.setCsv(parser.isSet(csvOption));
+
+    // without either the run would never end
+    if(!parser.isSet(requestsOption) && parser.isSet(durationOption))
+        bench.setRequests(0);
+    else if(parser.value(requestsOption).toLongLong() <= 0 && parser.value(durationOption).toInt() <= 0)
+        bench.setRequests(20000);
+
+    QObject::connect(&bench, SIGNAL(done()), &app, SLOT(quit()));
+
+    bench.start();
+    app.exec();
+
+    return bench.exitCode();
+}
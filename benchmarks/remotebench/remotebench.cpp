@@ -0,0 +1,567 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "remotebench.h"
+
+#include <QDataStream>
+#include <QStringList>
+
+// requests still unanswered this long after the last one went out are lost
+#define DRAIN_TIMEOUT 10000
+
+BenchClient::BenchClient(int id, RemoteBench *bench) :
+    QObject(bench),
+    m_socket(this)
+{
+    m_id = id;
+    m_state = Connecting;
+    m_pBench = bench;
+    m_connectStarted = 0;
+    m_setupReplies = 0;
+    m_nextRequestId = 1;
+    m_fileInFlight = false;
+
+    connect( &m_socket, SIGNAL(connected()), SLOT(onConnected()) );
+    connect( &m_socket, SIGNAL(readyRead()), SLOT(onReadyRead()) );
+    connect( &m_socket, SIGNAL(disconnected()), SLOT(onDisconnected()) );
+    connect( &m_socket, SIGNAL(error(QAbstractSocket::SocketError)), SLOT(onError(QAbstractSocket::SocketError)) );
+}
+
+void BenchClient::connectToServer(const QString &host, quint16 port)
+{
+    m_connectStarted = m_pBench->now();
+    m_socket.connectToHost(host, port);
+}
+
+void BenchClient::close()
+{
+    if(m_state == Closed)
+        return;
+
+    foreach(const Request& request, m_pending)
+    {
+        m_pBench->recordLost(request.requestClass);
+    }
+
+    m_pending.clear();
+    m_state = Closed;
+
+    disconnect( &m_socket, 0, this, 0 );
+    m_socket.abort();
+}
+
+void BenchClient::fill()
+{
+    // one file transfer at a time, the server refuses a second one
+    int requestClass;
+    while(m_state == Ready && m_pending.size() < m_pBench->pipeline() &&
+          m_pBench->takeRequest(!m_fileInFlight, requestClass))
+    {
+        issue(requestClass);
+    }
+}
+
+void BenchClient::onConnected()
+{
+    m_socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+    // the auth timer on the server runs from here
+    m_state = Authenticating;
+    send(RemoteProtocol::Challenge, QByteArray());
+}
+
+void BenchClient::onReadyRead()
+{
+    m_decoder.append(m_socket.readAll());
+
+    RemoteFrame frame;
+    while(m_state != Closed && m_decoder.next(frame))
+    {
+        handleFrame(frame);
+    }
+
+    if(m_decoder.hasError())
+        fail("frame too large");
+}
+
+void BenchClient::onDisconnected()
+{
+    fail("disconnected");
+}
+
+void BenchClient::onError(QAbstractSocket::SocketError error)
+{
+    Q_UNUSED(error);
+
+    fail(m_socket.errorString());
+}
+
+void BenchClient::handleFrame(const RemoteFrame &received)
+{
+    RemoteFrame frame = received;
+
+    // everything compressed is inflated, the stream depends on every payload
+    if(frame.flags & RemoteProtocol::FlagCompressed)
+    {
+        QByteArray payload;
+        if(!m_inflater.inflate(frame.payload, payload))
+        {
+            fail("corrupt compressed payload");
+            return;
+        }
+        frame.payload = payload;
+    }
+
+    if(m_state == Authenticating)
+    {
+        if(frame.type == RemoteProtocol::Challenge)
+        {
+            send(RemoteProtocol::Response, challengeResponse(m_pBench->key(), frame.payload));
+            return;
+        }
+
+        if(frame.type != RemoteProtocol::Remote)
+            return;
+
+        if(frame.text() != "success")
+        {
+            fail(frame.text());
+            return;
+        }
+
+        m_pBench->recordAuth(m_pBench->now() - m_connectStarted);
+        prepare();
+        return;
+    }
+
+    if(m_state == Preparing)
+    {
+        // the resume token is not asked for
+        if(frame.requestId == 0 && frame.type != RemoteProtocol::Resume && --m_setupReplies == 0)
+            setReady();
+        return;
+    }
+
+    // answers after a refusal and anything pushed are not waited for
+    QHash<quint32, Request>::iterator request = m_pending.find(frame.requestId);
+    if(request == m_pending.end())
+        return;
+
+    request->bytes += frame.payload.size();
+
+    if(frame.type == RemoteProtocol::Reason)
+        complete(frame.requestId, true);
+    else if(frame.type == request->reply)
+        complete(frame.requestId, false);
+}
+
+void BenchClient::prepare()
+{
+    m_state = Preparing;
+    m_setupReplies = 0;
+
+    if(m_pBench->deflate() && m_inflater.start())
+    {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_9);
+        out << quint32(RemoteProtocol::CapDeflate);
+
+        send(RemoteProtocol::Hello, payload);
+        m_setupReplies++;
+    }
+
+    // updates are only served once the whole console went out
+    if(m_pBench->weight(BenchLogsUpdate) > 0)
+    {
+        send(RemoteProtocol::ServerLogs, QByteArray());
+        m_setupReplies++;
+    }
+
+    if(m_setupReplies == 0)
+        setReady();
+}
+
+void BenchClient::setReady()
+{
+    m_state = Ready;
+    fill();
+
+    // nothing may be left to ask for
+    m_pBench->queueCheck();
+}
+
+void BenchClient::issue(int requestClass)
+{
+    quint32 requestId = m_nextRequestId++;
+
+    Request request;
+    request.requestClass = requestClass;
+    request.reply = RemoteProtocol::ServerStatus;
+    request.sent = m_pBench->now();
+    request.bytes = 0;
+
+    switch(requestClass)
+    {
+    case BenchCommand:
+        // a command that went through has no answer, the status request
+        // behind it is answered once the server got past it
+        send(RemoteProtocol::Command, m_pBench->command().toUtf8(), requestId);
+        send(RemoteProtocol::ServerStatus, QByteArray(), requestId);
+        break;
+
+    case BenchStatus:
+        send(RemoteProtocol::ServerStatus, QByteArray(), requestId);
+        break;
+
+    case BenchLogsUpdate:
+        // same for an update when no line is new
+        send(RemoteProtocol::LogsUpdate, QByteArray(), requestId);
+        send(RemoteProtocol::ServerStatus, QByteArray(), requestId);
+        break;
+
+    case BenchFile:
+    {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_9);
+        out << qint64(0) << m_pBench->fileLength() << QString();
+
+        send(RemoteProtocol::FileHeader, payload, requestId);
+        request.reply = RemoteProtocol::FileEnd;
+        m_fileInFlight = true;
+        break;
+    }
+    }
+
+    m_pending.insert(requestId, request);
+}
+
+void BenchClient::send(quint8 type, const QByteArray &payload, quint32 requestId)
+{
+    QByteArray frame;
+    encodeFrame(frame, type, payload, requestId);
+    m_socket.write(frame);
+}
+
+void BenchClient::complete(quint32 requestId, bool error)
+{
+    Request request = m_pending.take(requestId);
+
+    if(request.requestClass == BenchFile)
+        m_fileInFlight = false;
+
+    m_pBench->recordReply(request.requestClass, m_pBench->now() - request.sent, request.bytes, error);
+    fill();
+}
+
+void BenchClient::fail(const QString &reason)
+{
+    if(m_state == Closed)
+        return;
+
+    bool verified = m_state >= Preparing;
+
+    close();
+    m_pBench->recordFailure(QString("#%1 %2").arg(m_id).arg(reason), verified);
+}
+
+RemoteBench::RemoteBench(QObject *parent) :
+    QObject(parent),
+    m_out(stdout)
+{
+    m_host = "127.0.0.1";
+    m_port = 7777;
+    m_connections = 16;
+    m_pipeline = 1;
+    m_requests = 20000;
+    m_duration = 0;
+    m_command = "texttest";
+    m_fileLength = 64 * 1024;
+    m_deflate = false;
+    m_csv = false;
+    m_exitCode = 0;
+    m_fileOnly = false;
+
+    for(int i = 0; i < BenchClassCount; i++)
+    {
+        m_weights[i] = 0;
+        m_errors[i] = 0;
+        m_bytes[i] = 0;
+    }
+
+    m_deadlineTimer.setSingleShot(true);
+    connect( &m_deadlineTimer, SIGNAL(timeout()), SLOT(onDeadline()) );
+
+    m_drainTimer.setSingleShot(true);
+    connect( &m_drainTimer, SIGNAL(timeout()), SLOT(onDrainTimeout()) );
+
+    m_stopped = false;
+    m_finished = false;
+    m_checkQueued = false;
+    m_issued = 0;
+    m_firstRequest = 0;
+    m_lastReply = 0;
+    m_verified = 0;
+    m_refused = 0;
+    m_dropped = 0;
+}
+
+RemoteBench::~RemoteBench()
+{
+}
+
+QString RemoteBench::className(int requestClass)
+{
+    switch(requestClass)
+    {
+    case BenchCommand: return "command";
+    case BenchStatus: return "status";
+    case BenchLogsUpdate: return "update";
+    case BenchFile: return "file";
+    default: return QString();
+    }
+}
+
+void RemoteBench::start()
+{
+    int withoutFile[BenchClassCount];
+    int otherWeight = 0;
+
+    for(int i = 0; i < BenchClassCount; i++)
+    {
+        withoutFile[i] = (i == BenchFile) ? 0 : m_weights[i];
+        otherWeight += withoutFile[i];
+    }
+
+    m_classes = std::discrete_distribution<int>(m_weights, m_weights + BenchClassCount);
+    m_classesWithoutFile = std::discrete_distribution<int>(withoutFile, withoutFile + BenchClassCount);
+    m_fileOnly = (otherWeight == 0);
+
+    m_clock.start();
+
+    if(m_duration > 0)
+        m_deadlineTimer.start(m_duration * 1000);
+
+    for(int i = 0; i < m_connections; i++)
+    {
+        BenchClient* client = new BenchClient(i + 1, this);
+        m_clients.append(client);
+        client->connectToServer(m_host, m_port);
+    }
+}
+
+bool RemoteBench::takeRequest(bool fileAllowed, int &requestClass)
+{
+    if(m_stopped || (m_requests > 0 && m_issued >= m_requests))
+        return false;
+
+    // with a transfer running the connection asks for something else,
+    // file requests come out a little under their weight then
+    if(fileAllowed)
+        requestClass = m_classes(m_random);
+    else if(!m_fileOnly)
+        requestClass = m_classesWithoutFile(m_random);
+    else
+        return false;
+
+    if(m_issued == 0)
+        m_firstRequest = now();
+
+    m_issued++;
+
+    if(m_issued == m_requests)
+        m_drainTimer.start(DRAIN_TIMEOUT);
+
+    return true;
+}
+
+void RemoteBench::recordAuth(qint64 latency)
+{
+    m_authLatency.add(latency);
+    m_verified++;
+}
+
+void RemoteBench::recordReply(int requestClass, qint64 latency, qint64 bytes, bool error)
+{
+    m_latency[requestClass].add(latency);
+    m_bytes[requestClass] += bytes;
+    m_lastReply = now();
+
+    if(error)
+        m_errors[requestClass]++;
+
+    if(m_stopped || (m_requests > 0 && m_issued >= m_requests))
+        queueCheck();
+}
+
+void RemoteBench::recordLost(int requestClass)
+{
+    m_errors[requestClass]++;
+}
+
+void RemoteBench::recordFailure(const QString &reason, bool verified)
+{
+    if(verified)
+        m_dropped++;
+    else
+        m_refused++;
+
+    m_lastFailure = reason;
+    queueCheck();
+}
+
+void RemoteBench::queueCheck()
+{
+    if(m_checkQueued || m_finished)
+        return;
+
+    m_checkQueued = true;
+    QTimer::singleShot(0, this, SLOT(checkDone()));
+}
+
+void RemoteBench::onDeadline()
+{
+    m_stopped = true;
+    m_drainTimer.start(DRAIN_TIMEOUT);
+    queueCheck();
+}
+
+void RemoteBench::onDrainTimeout()
+{
+    finish();
+}
+
+void RemoteBench::checkDone()
+{
+    m_checkQueued = false;
+
+    if(m_finished)
+        return;
+
+    bool exhausted = m_stopped || (m_requests > 0 && m_issued >= m_requests);
+    bool open = false;
+
+    foreach(BenchClient* client, m_clients)
+    {
+        if(client->isClosed())
+            continue;
+
+        open = true;
+
+        // connections still on their way in are part of the run
+        if(!exhausted || client->isConnecting() || client->pendingCount() > 0)
+            return;
+    }
+
+    if(exhausted || !open)
+        finish();
+}
+
+void RemoteBench::finish()
+{
+    m_finished = true;
+    m_deadlineTimer.stop();
+    m_drainTimer.stop();
+
+    // whatever is still unanswered counts as an error
+    foreach(BenchClient* client, m_clients)
+    {
+        client->close();
+    }
+
+    double seconds = qMax(qint64(1), m_lastReply - m_firstRequest) / 1000000.0;
+
+    QStringList header;
+    header << "request" << "count" << "errors" << "req/s" << "MB/s"
+           << "p50 ms" << "p99 ms" << "p999 ms" << "max ms";
+
+    if(m_csv)
+    {
+        m_out << header.join(",") << Qt::endl;
+    }
+    else
+    {
+        m_out << header.at(0).leftJustified(10);
+        for(int i = 1; i < header.size(); i++)
+        {
+            m_out << header.at(i).rightJustified(10);
+        }
+        m_out << Qt::endl;
+    }
+
+    // connection and verification, no rate
+    printRow("auth", m_authLatency, m_refused, 0, 0);
+
+    LatencyHistogram total;
+    qint64 totalErrors = 0;
+    qint64 totalBytes = 0;
+
+    for(int i = 0; i < BenchClassCount; i++)
+    {
+        if(m_weights[i] == 0)
+            continue;
+
+        printRow(className(i), m_latency[i], m_errors[i], m_bytes[i], seconds);
+
+        total.merge(m_latency[i]);
+        totalErrors += m_errors[i];
+        totalBytes += m_bytes[i];
+    }
+
+    printRow("total", total, totalErrors, totalBytes, seconds);
+
+    if(!m_csv)
+    {
+        m_out << QString("%1 connections: %2 verified, %3 refused, %4 dropped")
+                 .arg(m_clients.size()).arg(m_verified).arg(m_refused).arg(m_dropped) << Qt::endl;
+
+        if(!m_lastFailure.isEmpty())
+            m_out << "last failure: " << m_lastFailure << Qt::endl;
+    }
+
+    m_exitCode = (m_verified > 0) ? 0 : 1;
+    emit done();
+}
+
+void RemoteBench::printRow(const QString &name, const LatencyHistogram &latency, qint64 errors, qint64 bytes, double seconds)
+{
+    QStringList row;
+
+    row << name
+        << QString::number(latency.count())
+        << QString::number(errors)
+        << (seconds > 0 ? QString::number(latency.count() / seconds, 'f', 0) : QString("-"))
+        << (seconds > 0 ? QString::number(bytes / seconds / (1024 * 1024), 'f', 2) : QString("-"))
+        << QString::number(latency.percentile(0.50) / 1000.0, 'f', 2)
+        << QString::number(latency.percentile(0.99) / 1000.0, 'f', 2)
+        << QString::number(latency.percentile(0.999) / 1000.0, 'f', 2)
+        << QString::number(latency.max() / 1000.0, 'f', 2);
+
+    if(m_csv)
+    {
+        m_out << row.join(",") << Qt::endl;
+        return;
+    }
+
+    m_out << row.at(0).leftJustified(10);
+    for(int i = 1; i < row.size(); i++)
+    {
+        m_out << row.at(i).rightJustified(10);
+    }
+    m_out << Qt::endl;
+}
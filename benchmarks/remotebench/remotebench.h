@@ -0,0 +1,218 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REMOTEBENCH_H
+#define REMOTEBENCH_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QTextStream>
+
+#include <random>
+
+#include "remoteprotocol.h"
+#include "latencyhistogram.h"
+
+class RemoteBench;
+
+// what a benchmark request asks the server for
+enum BenchRequestClass
+{
+    BenchCommand = 0,       // console command
+    BenchStatus,            // mcServerStatus
+    BenchLogsUpdate,        // mcLogsUpdate
+    BenchFile,              // a range of latest.log
+    BenchClassCount
+};
+
+// One connection to the remote server: answers the key challenge,
+// then keeps up to the pipeline depth of requests in flight and hands
+// every answer to the bench.
+class BenchClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchClient(int id, RemoteBench* bench);
+
+    void connectToServer(const QString& host, quint16 port);
+    void close();
+
+    bool isConnecting() const {return m_state < Ready;}
+    bool isClosed() const {return m_state == Closed;}
+    int pendingCount() const {return m_pending.size();}
+
+    // issues requests until the pipeline is full or the bench has none left
+    void fill();
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+    void onError(QAbstractSocket::SocketError error);
+
+private:
+    enum State
+    {
+        Connecting,
+        Authenticating,
+        Preparing,
+        Ready,
+        Closed
+    };
+
+    struct Request
+    {
+        int requestClass;
+        quint8 reply;       // frame type that completes the request
+        qint64 sent;
+        qint64 bytes;
+    };
+
+    void handleFrame(const RemoteFrame& frame);
+    void prepare();
+    void setReady();
+    void issue(int requestClass);
+    void send(quint8 type, const QByteArray& payload, quint32 requestId = 0);
+    void complete(quint32 requestId, bool error);
+    void fail(const QString& reason);
+
+    int m_id;
+    State m_state;
+    RemoteBench* m_pBench;
+    QTcpSocket m_socket;
+    FrameDecoder m_decoder;
+    FrameInflater m_inflater;
+
+    qint64 m_connectStarted;
+    int m_setupReplies;
+    quint32 m_nextRequestId;
+    QHash<quint32, Request> m_pending;
+    bool m_fileInFlight;
+};
+
+// Opens many connections to the remote control listener and fires a
+// weighted mix of requests at it, closed loop, then reports throughput
+// and latency percentiles per request class.
+class RemoteBench : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RemoteBench(QObject *parent = 0);
+    ~RemoteBench();
+
+    void setServer(const QString& host, quint16 port) {m_host = host; m_port = port;}
+    void setKey(const QByteArray& key) {m_key = key;}
+    void setConnections(int connections) {m_connections = connections;}
+    void setPipeline(int pipeline) {m_pipeline = pipeline;}
+    void setRequests(qint64 requests) {m_requests = requests;}
+    void setDuration(int seconds) {m_duration = seconds;}
+    void setWeight(int requestClass, int weight) {m_weights[requestClass] = weight;}
+    void setCommand(const QString& command) {m_command = command;}
+    void setFileLength(qint64 length) {m_fileLength = length;}
+    void setDeflate(bool deflate) {m_deflate = deflate;}
+    void setSeed(quint32 seed) {m_random.seed(seed);}
+    void setCsv(bool csv) {m_csv = csv;}
+
+    QByteArray key() const {return m_key;}
+    int pipeline() const {return m_pipeline;}
+    int weight(int requestClass) const {return m_weights[requestClass];}
+    QString command() const {return m_command;}
+    qint64 fileLength() const {return m_fileLength;}
+    bool deflate() const {return m_deflate;}
+
+    static QString className(int requestClass);
+
+    void start();
+
+    int exitCode() const {return m_exitCode;}
+
+    // microseconds since the bench started, on a steady clock
+    qint64 now() const {return m_clock.nsecsElapsed() / 1000;}
+
+    // false when no request is left, the class otherwise
+    bool takeRequest(bool fileAllowed, int& requestClass);
+
+    void recordAuth(qint64 latency);
+    void recordReply(int requestClass, qint64 latency, qint64 bytes, bool error);
+    void recordLost(int requestClass);
+    void recordFailure(const QString& reason, bool verified);
+
+    // looks for the end of the run once control is back in the event loop
+    void queueCheck();
+
+signals:
+    void done();
+
+private slots:
+    void onDeadline();
+    void onDrainTimeout();
+    void checkDone();
+
+private:
+    void finish();
+    void printRow(const QString& name, const LatencyHistogram& latency, qint64 errors, qint64 bytes, double seconds);
+
+    QString m_host;
+    quint16 m_port;
+    QByteArray m_key;
+    int m_connections;
+    int m_pipeline;
+    qint64 m_requests;
+    int m_duration;
+    int m_weights[BenchClassCount];
+    QString m_command;
+    qint64 m_fileLength;
+    bool m_deflate;
+    bool m_csv;
+    int m_exitCode;
+
+    QList<BenchClient*> m_clients;
+    std::mt19937 m_random;
+    std::discrete_distribution<int> m_classes;
+    std::discrete_distribution<int> m_classesWithoutFile;
+    bool m_fileOnly;
+
+    QElapsedTimer m_clock;
+    QTimer m_deadlineTimer;
+    QTimer m_drainTimer;
+    bool m_stopped;
+    bool m_finished;
+    bool m_checkQueued;
+
+    qint64 m_issued;
+    qint64 m_firstRequest;
+    qint64 m_lastReply;
+    int m_verified;
+    int m_refused;
+    int m_dropped;
+    QString m_lastFailure;
+
+    LatencyHistogram m_authLatency;
+    LatencyHistogram m_latency[BenchClassCount];
+    qint64 m_errors[BenchClassCount];
+    qint64 m_bytes[BenchClassCount];
+
+    QTextStream m_out;
+};
+
+#endif // REMOTEBENCH_H
@@ -0,0 +1,38 @@
+#-------------------------------------------------
+# Qt Minecraft Server
+# Copyleft 2013
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = remotebench
+TEMPLATE = app
+
+include(../benchmarks.pri)
+
+INCLUDEPATH += $$PWD/../..
+DEPENDPATH += $$PWD/../..
+
+# remote payload compression, Windows builds use the zlib inside QtCore
+unix: LIBS += -lz
+
+SOURCES += main.cpp \
+    remotebench.cpp \
+    $$PWD/../../remoteprotocol.cpp
+
+HEADERS += remotebench.h \
+    $$PWD/../../remoteprotocol.h
@@ -0,0 +1,41 @@
+#-------------------------------------------------
+# Qt Minecraft Server
+# Copyleft 2013
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#-------------------------------------------------
+
+# Server process and console pipeline: capture, parsing, journal and
+# styling. QtCore only, the scrollback model is in consoleview.pri.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/consolebuffer.cpp \
+    $$PWD/consoleingester.cpp \
+    $$PWD/serverprocess.cpp \
+    $$PWD/loglineparser.cpp \
+    $$PWD/consolejournal.cpp \
+    $$PWD/consolestyle.cpp
+
+HEADERS += \
+    $$PWD/consolebuffer.h \
+    $$PWD/consoleingester.h \
+    $$PWD/spscqueue.h \
+    $$PWD/serverprocess.h \
+    $$PWD/logevent.h \
+    $$PWD/loglineparser.h \
+    $$PWD/consolejournal.h \
+    $$PWD/consolestyle.h
@@ -0,0 +1,173 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consolebuffer.h"
+#include "consolestyle.h"
+
+ConsoleBuffer::ConsoleBuffer(int capacity)
+{
+    m_lines.resize(qMax(capacity, 1));
+    m_head = 0;
+    m_count = 0;
+    m_firstSequence = 0;
+    m_nextSequence = 0;
+}
+
+void ConsoleBuffer::setCapacity(int capacity)
+{
+    capacity = qMax(capacity, 1);
+
+    if(capacity == m_lines.size())
+        return;
+
+    // keep the newest lines that still fit
+    QVector<ConsoleLine> lines(capacity);
+    int keep = qMin(m_count, capacity);
+    int skip = m_count - keep;
+
+    for(int i = 0; i < keep; i++)
+    {
+        lines[i] = at(skip + i);
+    }
+
+    m_lines = lines;
+    m_head = 0;
+    m_count = keep;
+    m_firstSequence = (keep > 0) ? m_lines.at(0).sequence : m_nextSequence;
+}
+
+const ConsoleLine& ConsoleBuffer::at(int index) const
+{
+    return m_lines.at((m_head + index) % m_lines.size());
+}
+
+int ConsoleBuffer::indexOf(quint64 sequence) const
+{
+    if(sequence <= m_firstSequence)
+        return 0;
+
+    if(sequence >= m_nextSequence)
+        return m_count;
+
+    // the numbers only grow, but may skip dropped lines
+    int low = 0;
+    int high = m_count;
+
+    while(low < high)
+    {
+        int middle = (low + high) / 2;
+
+        if(at(middle).sequence < sequence)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+int ConsoleBuffer::append(const ConsoleLine& line)
+{
+    int capacity = m_lines.size();
+
+    // an empty buffer takes over the numbering of the stream
+    if(m_count == 0)
+        m_firstSequence = line.sequence;
+    else
+        Q_ASSERT(line.sequence >= m_nextSequence);
+
+    m_nextSequence = line.sequence + 1;
+
+    if(m_count < capacity)
+    {
+        m_lines[(m_head + m_count) % capacity] = line;
+        m_count++;
+        return 0;
+    }
+
+    // full, overwrite the oldest line
+    m_lines[m_head] = line;
+    m_head = (m_head + 1) % capacity;
+    m_firstSequence = at(0).sequence;
+    return 1;
+}
+
+void ConsoleBuffer::removeFirst(int count)
+{
+    count = qMin(count, m_count);
+
+    for(int i = 0; i < count; i++)
+    {
+        m_lines[m_head] = ConsoleLine();
+        m_head = (m_head + 1) % m_lines.size();
+    }
+
+    m_count -= count;
+    m_firstSequence = (m_count > 0) ? at(0).sequence : m_nextSequence;
+}
+
+void ConsoleBuffer::clear()
+{
+    for(int i = 0; i < m_lines.size(); i++)
+    {
+        m_lines[i] = ConsoleLine();
+    }
+
+    m_firstSequence = m_nextSequence;
+    m_head = 0;
+    m_count = 0;
+}
+
+QString ConsoleBuffer::toPlainText() const
+{
+    QString text;
+
+    for(int i = 0; i < m_count; i++)
+    {
+        text += at(i).text;
+        text += QLatin1Char('\n');
+    }
+
+    return text;
+}
+
+QString ConsoleBuffer::toHtml(int index, int count) const
+{
+    QString html;
+
+    index = qBound(0, index, m_count);
+    count = qBound(0, count, m_count - index);
+
+    for(int i = index; i < index + count; i++)
+    {
+        const ConsoleLine& line = at(i);
+
+        if(line.style == ConsoleStyle::Plain)
+        {
+            html += line.text.toHtmlEscaped();
+        }
+        else
+        {
+            html += QString("<font color=\"%1\">%2</font>").arg(QLatin1String(ConsoleStyle::colorName(line.style)))
+                                                           .arg(line.text.toHtmlEscaped());
+        }
+
+        html += QLatin1String("<br>");
+    }
+
+    return html;
+}
@@ -0,0 +1,89 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLEBUFFER_H
+#define CONSOLEBUFFER_H
+
+#include <QString>
+#include <QVector>
+#include <QMetaType>
+
+#include "logevent.h"
+
+struct ConsoleLine
+{
+    ConsoleLine() :
+        sequence(0),
+        timestamp(0),
+        style(0)
+    {
+    }
+
+    QString text;
+    quint64 sequence;   // position in the merged console stream
+    qint64 timestamp;   // msecs since epoch when the line was read
+    LogEvent event;
+    quint8 style;       // ConsoleStyle::Style
+};
+
+Q_DECLARE_METATYPE(ConsoleLine)
+
+// Fixed-capacity ring buffer of console lines.
+// Index 0 is the oldest line still held, every line also has a
+// sequence number that keeps growing when old lines are dropped.
+// Sequence numbers may skip lines the ingester had to drop, the
+// buffer follows the numbers of the lines rather than counting them.
+class ConsoleBuffer
+{
+public:
+    explicit ConsoleBuffer(int capacity = 50000);
+
+    int capacity() const {return m_lines.size();}
+    void setCapacity(int capacity);
+
+    int size() const {return m_count;}
+    bool isEmpty() const {return m_count == 0;}
+
+    const ConsoleLine& at(int index) const;
+
+    quint64 firstSequence() const {return m_firstSequence;}
+    quint64 nextSequence() const {return m_nextSequence;}
+
+    // index of the first line at or after sequence, size() if none
+    int indexOf(quint64 sequence) const;
+
+    // returns the number of old lines dropped to make room (0 or 1),
+    // lines are expected to come in sequence order
+    int append(const ConsoleLine& line);
+    void removeFirst(int count);
+    void clear();
+
+    QString toPlainText() const;
+    QString toHtml() const {return toHtml(0, m_count);}
+
+    // count lines starting at index, the cost depends on count only
+    QString toHtml(int index, int count) const;
+
+private:
+    QVector<ConsoleLine> m_lines;
+    int m_head;
+    int m_count;
+    quint64 m_firstSequence;
+    quint64 m_nextSequence;
+};
+
+#endif // CONSOLEBUFFER_H
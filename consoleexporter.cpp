@@ -0,0 +1,210 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consoleexporter.h"
+#include "consolejournal.h"
+
+#include <QFileInfo>
+
+// bytes collected before they are handed to the file
+#define CHUNK_SIZE (256 * 1024)
+
+// the cancel flag is polled once per this many lines
+#define CANCEL_CHECK_LINES 1024
+
+ConsoleExporter::ConsoleExporter(const QString &fileName, const ExportFilter &filter, QObject *parent) :
+    QObject(parent),
+    m_fileName(fileName),
+    m_filter(filter),
+    m_buffer(1)
+{
+    m_lines = 0;
+    m_percent = -1;
+    m_keepContinuation = true;
+}
+
+void ConsoleExporter::run()
+{
+    m_lines = 0;
+    m_percent = -1;
+    m_keepContinuation = (m_filter.minimumLevel <= LogEvent::LevelUnknown);
+    m_chunk.clear();
+    m_chunk.reserve(CHUNK_SIZE + 4096);
+
+    m_file.setFileName(m_fileName);
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        m_errorString = m_file.errorString();
+        emit finished(Failed, 0);
+        return;
+    }
+
+    bool ok = m_segments.isEmpty() ? exportBuffer() : exportJournal();
+
+    if(ok)
+        ok = writeChunk(true);
+
+    m_file.close();
+
+    if(!ok)
+    {
+        // a half written export is of no use to anybody
+        m_file.remove();
+        emit finished(m_canceled.loadAcquire() ? Canceled : Failed, m_lines);
+        return;
+    }
+
+    emit progress(100);
+    emit finished(Succeeded, m_lines);
+}
+
+bool ConsoleExporter::exportJournal()
+{
+    qint64 total = 0;
+    foreach(const QString& segment, m_segments)
+    {
+        total += QFileInfo(segment).size();
+    }
+
+    qint64 done = 0;
+
+    foreach(const QString& segment, m_segments)
+    {
+        JournalReader reader(segment);
+        qint64 segmentSize = QFileInfo(segment).size();
+
+        if(reader.open())
+        {
+            JournalRecord record;
+            int count = 0;
+
+            while(reader.next(record))
+            {
+                if(++count == CANCEL_CHECK_LINES)
+                {
+                    count = 0;
+
+                    if(m_canceled.loadAcquire())
+                        return false;
+
+                    reportProgress(done + reader.position(), total);
+                }
+
+                if(m_filter.from >= 0 && record.timestamp < m_filter.from)
+                    continue;
+
+                // timestamps are read times, a line may be journaled after a newer one
+                if(m_filter.to >= 0 && record.timestamp > m_filter.to)
+                    continue;
+
+                if(!acceptLevel(record.event))
+                    continue;
+
+                m_chunk.append(record.text, record.textSize);
+                m_chunk.append('\n');
+                m_lines++;
+
+                if(!writeChunk(false))
+                    return false;
+            }
+        }
+
+        done += segmentSize;
+        reportProgress(done, total);
+    }
+
+    return true;
+}
+
+bool ConsoleExporter::exportBuffer()
+{
+    int size = m_buffer.size();
+
+    for(int i = 0; i < size; i++)
+    {
+        if((i % CANCEL_CHECK_LINES) == 0)
+        {
+            if(m_canceled.loadAcquire())
+                return false;
+
+            reportProgress(i, size);
+        }
+
+        const ConsoleLine& line = m_buffer.at(i);
+
+        // messages are stamped when posted, not strictly in time order
+        if(m_filter.from >= 0 && line.timestamp < m_filter.from)
+            continue;
+
+        if(m_filter.to >= 0 && line.timestamp > m_filter.to)
+            continue;
+
+        if(!acceptLevel(line.event))
+            continue;
+
+        m_chunk.append(line.text.toUtf8());
+        m_chunk.append('\n');
+        m_lines++;
+
+        if(!writeChunk(false))
+            return false;
+    }
+
+    return true;
+}
+
+bool ConsoleExporter::acceptLevel(const LogEvent &event)
+{
+    if(m_filter.minimumLevel <= LogEvent::LevelUnknown)
+        return true;
+
+    if(event.channel == LogEvent::ChannelApplication)
+        return false;
+
+    // stack traces and other continuation lines go with the line they follow
+    if(event.level != LogEvent::LevelUnknown)
+        m_keepContinuation = (event.level >= m_filter.minimumLevel);
+
+    return m_keepContinuation;
+}
+
+bool ConsoleExporter::writeChunk(bool force)
+{
+    if(m_chunk.isEmpty() || (!force && m_chunk.size() < CHUNK_SIZE))
+        return true;
+
+    if(m_file.write(m_chunk) != m_chunk.size())
+    {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    // keeps the reserved capacity
+    m_chunk.resize(0);
+    return true;
+}
+
+void ConsoleExporter::reportProgress(qint64 done, qint64 total)
+{
+    int percent = (total > 0) ? int(done * 100 / total) : 0;
+
+    if(percent != m_percent)
+    {
+        m_percent = percent;
+        emit progress(percent);
+    }
+}
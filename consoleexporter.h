@@ -0,0 +1,99 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLEEXPORTER_H
+#define CONSOLEEXPORTER_H
+
+#include <QObject>
+#include <QFile>
+#include <QStringList>
+#include <QAtomicInt>
+
+#include "consolebuffer.h"
+
+// Which lines go into an export.
+struct ExportFilter
+{
+    ExportFilter() :
+        minimumLevel(LogEvent::LevelUnknown),
+        from(-1),
+        to(-1)
+    {
+    }
+
+    int minimumLevel;   // LogEvent::Level, LevelUnknown keeps every line
+    qint64 from;        // msecs since epoch, -1 for no limit
+    qint64 to;
+};
+
+// Writes the console to a text file in chunks. Meant to be moved to a
+// worker thread and started through run(), the lines come either from
+// the journal segments or from a snapshot of the scrollback.
+class ConsoleExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Result
+    {
+        Succeeded = 0,
+        Failed,
+        Canceled
+    };
+
+    explicit ConsoleExporter(const QString& fileName, const ExportFilter& filter, QObject *parent = 0);
+
+    // journal segments, oldest first
+    void setJournal(const QStringList& segments) {m_segments = segments;}
+
+    // the buffer is implicitly shared, the snapshot costs no line copies
+    void setLines(const ConsoleBuffer& buffer) {m_buffer = buffer;}
+
+    QString errorString() const {return m_errorString;}
+
+public slots:
+    void run();
+
+    // may be called from any thread
+    void cancel() {m_canceled.storeRelease(1);}
+
+signals:
+    void progress(int percent);
+    void finished(int result, qint64 lines);
+
+private:
+    bool exportJournal();
+    bool exportBuffer();
+    bool acceptLevel(const LogEvent& event);
+    bool writeChunk(bool force);
+    void reportProgress(qint64 done, qint64 total);
+
+    QString m_fileName;
+    ExportFilter m_filter;
+    QStringList m_segments;
+    ConsoleBuffer m_buffer;
+
+    QFile m_file;
+    QByteArray m_chunk;
+    qint64 m_lines;
+    int m_percent;
+    bool m_keepContinuation;
+    QString m_errorString;
+    QAtomicInt m_canceled;
+};
+
+#endif // CONSOLEEXPORTER_H
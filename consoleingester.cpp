@@ -0,0 +1,311 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consoleingester.h"
+#include "consolejournal.h"
+#include "consolestyle.h"
+
+#include <QDateTime>
+
+// a line without end that grows past this is handed out anyway
+#define MAX_CARRY_SIZE (64 * 1024)
+
+// how long a partial line may hold back the other channel, in msecs
+#define MAX_HOLD_TIME 100
+
+#define QUEUE_CAPACITY 65536
+#define RETRY_INTERVAL 50
+
+// lines kept while the queue is full, older ones are dropped from the
+// console (the journal still has them) and counted in a notice
+#define MAX_OVERFLOW_LINES 65536
+
+ConsoleIngester::ConsoleIngester(QObject *parent) :
+    QObject(parent),
+    m_retryTimer(this),
+    m_queue(QUEUE_CAPACITY)
+{
+    m_pJournal = 0;
+
+    m_nextRead = 0;
+    m_readTime = 0;
+    m_nextSequence = 0;
+    m_dropped = 0;
+    m_droppedSequence = 0;
+    m_droppedTime = 0;
+    m_clock.start();
+
+    for(int channel = StandardOutput; channel <= StandardError; channel++)
+    {
+        m_carryRead[channel] = 0;
+        m_carrySince[channel] = 0;
+    }
+
+    m_retryTimer.setSingleShot(true);
+    connect(&m_retryTimer, SIGNAL(timeout()), SLOT(publish()));
+}
+
+void ConsoleIngester::feed(Channel channel, const QByteArray &data)
+{
+    if(data.isEmpty())
+        return;
+
+    quint64 read = m_nextRead++;
+    m_readTime = QDateTime::currentMSecsSinceEpoch();
+
+    QByteArray& carry = m_carry[channel];
+    int start = 0;
+    int end;
+
+    while((end = data.indexOf('\n', start)) != -1)
+    {
+        if(carry.isEmpty())
+        {
+            // straight from the read buffer, no copy of the line
+            takeLine(channel, read, data.constData() + start, end - start);
+        }
+        else
+        {
+            carry.append(data.constData() + start, end - start);
+            takeLine(channel, m_carryRead[channel], carry.constData(), carry.size());
+            carry.clear();
+        }
+
+        start = end + 1;
+    }
+
+    if(start < data.size())
+    {
+        if(carry.isEmpty())
+        {
+            m_carryRead[channel] = read;
+            m_carrySince[channel] = m_clock.elapsed();
+        }
+
+        carry.append(data.constData() + start, data.size() - start);
+
+        if(carry.size() > MAX_CARRY_SIZE)
+        {
+            takeLine(channel, m_carryRead[channel], carry.constData(), carry.size());
+            carry.clear();
+        }
+    }
+
+    publish();
+}
+
+void ConsoleIngester::finish()
+{
+    for(int channel = StandardOutput; channel <= StandardError; channel++)
+    {
+        if(!m_carry[channel].isEmpty())
+        {
+            takeLine(Channel(channel), m_carryRead[channel], m_carry[channel].constData(), m_carry[channel].size());
+            m_carry[channel].clear();
+        }
+    }
+
+    releaseHeld(true);
+    publish();
+}
+
+void ConsoleIngester::post(const QString &text, int style)
+{
+    // closes the lines held so far, a partial line does not keep it back
+    releaseHeld(true);
+
+    QByteArray utf8 = text.toUtf8();
+
+    ConsoleLine line;
+    line.timestamp = QDateTime::currentMSecsSinceEpoch();
+    line.style = quint8(style);
+    line.event.channel = LogEvent::ChannelApplication;
+
+    releaseLine(line, utf8.constData(), utf8.size());
+    publish();
+}
+
+int ConsoleIngester::drain(QVector<ConsoleLine> &lines, int maxLines)
+{
+    // re-arm first, so lines pushed while draining signal again
+    m_signalled.storeRelease(0);
+
+    int count = 0;
+    ConsoleLine line;
+
+    while(count < maxLines && m_queue.pop(line))
+    {
+        lines.append(line);
+        count++;
+    }
+
+    return count;
+}
+
+void ConsoleIngester::publish()
+{
+    // a line that ended may unblock the other channel, and held lines
+    // are released once the partial line in front of them is too old
+    releaseHeld(false);
+
+    // then the notice in place of the lines that were dropped
+    if(m_dropped > 0)
+    {
+        ConsoleLine notice;
+        notice.sequence = m_droppedSequence;
+        notice.timestamp = m_droppedTime;
+        notice.style = ConsoleStyle::Failure;
+        notice.event.channel = LogEvent::ChannelApplication;
+        notice.text = tr(">> %1 lines dropped, the console could not keep up").arg(m_dropped);
+        notice.event.messageLength = notice.text.size();
+
+        if(m_queue.push(notice))
+            m_dropped = 0;
+    }
+
+    // lines the GUI had no room for yet go first
+    while(m_dropped == 0 && !m_overflow.isEmpty() && m_queue.push(m_overflow.first()))
+    {
+        m_overflow.removeFirst();
+    }
+
+    if(m_dropped > 0 || !m_overflow.isEmpty() || !m_held[StandardOutput].isEmpty() || !m_held[StandardError].isEmpty())
+    {
+        if(!m_retryTimer.isActive())
+            m_retryTimer.start(RETRY_INTERVAL);
+    }
+
+    if(!m_queue.isEmpty() && m_signalled.testAndSetOrdered(0, 1))
+    {
+        emit linesAvailable();
+    }
+}
+
+void ConsoleIngester::takeLine(Channel channel, quint64 read, const char *data, int size)
+{
+    if(size > 0 && data[size - 1] == '\r')
+        size--;
+
+    if(size == 0)
+        return;
+
+    ConsoleLine line;
+
+    m_parser.parse(data, size, line.event);
+    line.event.channel = (channel == StandardOutput) ? LogEvent::ChannelStandardOutput
+                                                     : LogEvent::ChannelStandardError;
+    line.style = ConsoleStyle::classify(line.event);
+    line.timestamp = m_readTime;
+
+    if(m_held[channel].isEmpty() && !isBlocked(channel, read))
+    {
+        releaseLine(line, data, size);
+        return;
+    }
+
+    // only lines that have to wait are copied
+    HeldLine held;
+    held.read = read;
+    held.line = line;
+    held.data = QByteArray(data, size);
+
+    m_held[channel].append(held);
+}
+
+bool ConsoleIngester::isBlocked(Channel channel, quint64 read) const
+{
+    int other = 1 - channel;
+
+    if(!m_held[other].isEmpty() && m_held[other].first().read < read)
+        return true;
+
+    return !m_carry[other].isEmpty() && m_carryRead[other] < read &&
+           m_clock.elapsed() - m_carrySince[other] < MAX_HOLD_TIME;
+}
+
+void ConsoleIngester::releaseHeld(bool force)
+{
+    forever
+    {
+        // the older of the two heads goes first
+        int channel;
+
+        if(m_held[StandardOutput].isEmpty() && m_held[StandardError].isEmpty())
+            return;
+        else if(m_held[StandardOutput].isEmpty())
+            channel = StandardError;
+        else if(m_held[StandardError].isEmpty())
+            channel = StandardOutput;
+        else
+            channel = (m_held[StandardError].first().read < m_held[StandardOutput].first().read) ? StandardError
+                                                                                               : StandardOutput;
+
+        HeldLine& held = m_held[channel].first();
+
+        if(!force && isBlocked(Channel(channel), held.read))
+            return;
+
+        releaseLine(held.line, held.data.constData(), held.data.size());
+
+        m_held[channel].removeFirst();
+    }
+}
+
+void ConsoleIngester::releaseLine(ConsoleLine &line, const char *data, int size)
+{
+    line.sequence = m_nextSequence++;
+
+    if(m_pJournal)
+        m_pJournal->append(line, data, size);
+
+    // both channels are decoded the same way
+    line.text = QString::fromUtf8(data, size);
+    line.event.messageLength = line.text.size() - line.event.messageOffset;
+
+    queueLine(line);
+}
+
+void ConsoleIngester::restore(const QVector<ConsoleLine> &lines)
+{
+    // already numbered and journaled
+    foreach(const ConsoleLine& line, lines)
+    {
+        queueLine(line);
+    }
+
+    publish();
+}
+
+void ConsoleIngester::queueLine(const ConsoleLine &line)
+{
+    if(m_dropped > 0 || !m_overflow.isEmpty() || !m_queue.push(line))
+    {
+        if(m_overflow.size() >= MAX_OVERFLOW_LINES)
+        {
+            // the notice takes the sequence of the newest dropped line,
+            // the console and its clients skip the ones before it
+            const ConsoleLine& dropped = m_overflow.first();
+            m_droppedSequence = dropped.sequence;
+            m_droppedTime = dropped.timestamp;
+            m_dropped++;
+
+            m_overflow.removeFirst();
+        }
+
+        m_overflow.append(line);
+    }
+}
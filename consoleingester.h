@@ -0,0 +1,128 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLEINGESTER_H
+#define CONSOLEINGESTER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QTimer>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include "spscqueue.h"
+#include "consolebuffer.h"
+#include "loglineparser.h"
+
+class ConsoleJournal;
+
+// Collects raw process output on the I/O thread and splits it into
+// complete lines. A line split across two reads is carried over until
+// its end arrives. Every line is parsed into a LogEvent straight from
+// the read buffer and handed to the GUI thread through a lock-free
+// queue, the producer side never waits for the consumer. When the
+// consumer falls that far behind, a bounded overflow takes the rest and
+// its oldest lines make way for a notice counting them.
+//
+// stdout and stderr are merged into one ordered stream: every read is
+// numbered, a line is ordered by the read its first byte came in, and
+// a line is held back while the other channel still carries an older
+// partial line. Released lines get consecutive sequence numbers and the
+// time of their read, shared with the journal and the application
+// messages posted here.
+class ConsoleIngester : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Channel
+    {
+        StandardOutput = 0,
+        StandardError = 1
+    };
+
+    explicit ConsoleIngester(QObject *parent = 0);
+
+    // producer side, I/O thread only
+    void feed(Channel channel, const QByteArray& data);
+
+    // emits the partial lines still carried, e.g. when the process ended
+    void finish();
+
+    // application message, ordered after the server lines read so far
+    void post(const QString& text, int style);
+
+    // lines restored from the journal, ahead of everything new
+    void restore(const QVector<ConsoleLine>& lines);
+
+    // every released line is also appended to the journal, if set
+    void setJournal(ConsoleJournal* journal) {m_pJournal = journal;}
+
+    // sequence of the next line, to be set before the first one
+    void setNextSequence(quint64 sequence) {m_nextSequence = sequence;}
+
+    // consumer side, GUI thread only
+    int drain(QVector<ConsoleLine>& lines, int maxLines);
+
+    const LogLineParser& parser() const {return m_parser;}
+
+signals:
+    // emitted once until the consumer drains again
+    void linesAvailable();
+
+private slots:
+    void publish();
+
+private:
+    struct HeldLine
+    {
+        quint64 read;
+        ConsoleLine line;
+        QByteArray data;
+    };
+
+    void takeLine(Channel channel, quint64 read, const char* data, int size);
+    bool isBlocked(Channel channel, quint64 read) const;
+    void releaseHeld(bool force);
+    void releaseLine(ConsoleLine& line, const char* data, int size);
+    void queueLine(const ConsoleLine& line);
+
+    LogLineParser m_parser;
+    ConsoleJournal* m_pJournal;
+
+    quint64 m_nextRead;
+    qint64 m_readTime;
+    quint64 m_nextSequence;
+    QElapsedTimer m_clock;
+
+    QByteArray m_carry[2];
+    quint64 m_carryRead[2];
+    qint64 m_carrySince[2];
+    QList<HeldLine> m_held[2];
+
+    QList<ConsoleLine> m_overflow;
+    int m_dropped;
+    quint64 m_droppedSequence;
+    qint64 m_droppedTime;
+    QTimer m_retryTimer;
+
+    SpscQueue<ConsoleLine> m_queue;
+    QAtomicInt m_signalled;
+};
+
+#endif // CONSOLEINGESTER_H
@@ -0,0 +1,370 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consolejournal.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <string.h>
+
+// Segment layout: an 8 byte magic, then records. Each record is a
+// 32 byte little-endian header followed by the UTF-8 line, padded to
+// a multiple of 8 bytes:
+//   0 quint32 text size       4 quint8 level       5 quint8 channel
+//   6 quint8 style            7 reserved           8 qint32 time
+//  12 qint32 message offset  16 quint64 sequence  24 qint64 timestamp
+#define JOURNAL_MAGIC "QMCJRNL1"
+#define JOURNAL_MAGIC_SIZE 8
+#define RECORD_HEADER_SIZE 32
+
+#define MAX_RECORD_TEXT_SIZE (16 * 1024 * 1024)
+
+#define FLUSH_INTERVAL 1000
+
+static int paddedSize(int size)
+{
+    return (size + 7) & ~7;
+}
+
+static int segmentIndex(const QString& fileName)
+{
+    // console-00000001.journal
+    return QFileInfo(fileName).completeBaseName().mid(8).toInt();
+}
+
+JournalReader::JournalReader(const QString &fileName) :
+    m_file(fileName)
+{
+    m_data = 0;
+    m_size = 0;
+    m_position = 0;
+}
+
+JournalReader::~JournalReader()
+{
+    close();
+}
+
+bool JournalReader::open()
+{
+    close();
+
+    if(!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_size = m_file.size();
+    if(m_size < JOURNAL_MAGIC_SIZE)
+    {
+        close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_size);
+    if(!m_data || memcmp(m_data, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE) != 0)
+    {
+        close();
+        return false;
+    }
+
+    m_position = JOURNAL_MAGIC_SIZE;
+    return true;
+}
+
+void JournalReader::close()
+{
+    if(m_data)
+    {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = 0;
+    }
+
+    m_file.close();
+    m_size = 0;
+    m_position = 0;
+}
+
+bool JournalReader::next(JournalRecord &record)
+{
+    if(!m_data || m_size - m_position < RECORD_HEADER_SIZE)
+        return false;
+
+    const uchar* header = m_data + m_position;
+    quint32 textSize = qFromLittleEndian<quint32>(header);
+
+    if(textSize == 0 || textSize > MAX_RECORD_TEXT_SIZE ||
+       m_size - m_position - RECORD_HEADER_SIZE < paddedSize(int(textSize)))
+        return false;
+
+    record.event.level = header[4];
+    record.event.channel = header[5];
+    record.style = header[6];
+    record.event.thread = 0;
+    record.event.time = qFromLittleEndian<qint32>(header + 8);
+    record.event.messageOffset = qBound(0, qFromLittleEndian<qint32>(header + 12), int(textSize));
+    record.event.messageLength = int(textSize) - record.event.messageOffset;
+    record.sequence = qFromLittleEndian<quint64>(header + 16);
+    record.timestamp = qFromLittleEndian<qint64>(header + 24);
+    record.text = reinterpret_cast<const char*>(header + RECORD_HEADER_SIZE);
+    record.textSize = int(textSize);
+
+    m_position += RECORD_HEADER_SIZE + paddedSize(int(textSize));
+    return true;
+}
+
+ConsoleJournal::ConsoleJournal(QObject *parent) :
+    QObject(parent),
+    m_flushTimer(this)
+{
+    m_segmentSize = 16 * 1024 * 1024;
+    m_maxSegments = 32;
+    m_segmentIndex = 0;
+    m_nextSequence = 0;
+
+    m_flushTimer.setInterval(FLUSH_INTERVAL);
+    connect(&m_flushTimer, SIGNAL(timeout()), SLOT(flush()));
+}
+
+ConsoleJournal::~ConsoleJournal()
+{
+    close();
+}
+
+bool ConsoleJournal::open(const QString &directory, qint64 segmentSize, int maxSegments)
+{
+    close();
+
+    m_directory = directory;
+    m_segmentSize = qMax(segmentSize, qint64(64 * 1024));
+    m_maxSegments = qMax(maxSegments, 1);
+    m_nextSequence = 0;
+
+    if(!QDir().mkpath(directory))
+        return false;
+
+    QStringList files = segmentFiles(directory);
+    int index = files.isEmpty() ? 1 : segmentIndex(files.last()) + 1;
+    qint64 end = -1;
+
+    // continue the sequence after the last record written
+    for(int i = files.size() - 1; i >= 0; i--)
+    {
+        JournalReader reader(files.at(i));
+        if(!reader.open())
+            continue;
+
+        bool found = false;
+        JournalRecord record;
+        while(reader.next(record))
+        {
+            m_nextSequence = record.sequence + 1;
+            found = true;
+        }
+
+        if(i == files.size() - 1)
+            end = reader.position();
+
+        if(found)
+            break;
+    }
+
+    // keep writing into the last segment while it has room
+    if(end > 0 && end < m_segmentSize)
+    {
+        m_file.setFileName(files.last());
+
+        if(m_file.open(QIODevice::ReadWrite))
+        {
+            // drops a torn record left behind by a crash
+            m_file.resize(end);
+            m_file.seek(end);
+
+            m_segmentIndex = index - 1;
+            m_flushTimer.start();
+            return true;
+        }
+    }
+
+    return openSegment(index);
+}
+
+void ConsoleJournal::close()
+{
+    m_flushTimer.stop();
+
+    if(m_file.isOpen())
+    {
+        m_file.flush();
+        m_file.close();
+    }
+}
+
+void ConsoleJournal::append(const ConsoleLine &line, const char *text, int size)
+{
+    if(!m_file.isOpen() || size <= 0)
+        return;
+
+    if(m_file.pos() >= m_segmentSize)
+    {
+        if(!openSegment(m_segmentIndex + 1))
+            return;
+    }
+
+    int padded = paddedSize(size);
+    m_record.resize(RECORD_HEADER_SIZE + padded);
+
+    uchar* header = reinterpret_cast<uchar*>(m_record.data());
+    qToLittleEndian<quint32>(quint32(size), header);
+    header[4] = line.event.level;
+    header[5] = line.event.channel;
+    header[6] = line.style;
+    header[7] = 0;
+    qToLittleEndian<qint32>(line.event.time, header + 8);
+    qToLittleEndian<qint32>(line.event.messageOffset, header + 12);
+    qToLittleEndian<quint64>(line.sequence, header + 16);
+    qToLittleEndian<qint64>(line.timestamp, header + 24);
+
+    memcpy(header + RECORD_HEADER_SIZE, text, size);
+    memset(header + RECORD_HEADER_SIZE + size, 0, padded - size);
+
+    m_file.write(m_record);
+    m_nextSequence = line.sequence + 1;
+}
+
+void ConsoleJournal::flush()
+{
+    if(m_file.isOpen())
+        m_file.flush();
+}
+
+QStringList ConsoleJournal::segmentFiles(const QString &directory)
+{
+    QDir dir(directory);
+    QStringList files;
+
+    // zero padded indices, so sorting by name is sorting by age
+    foreach(const QString& name, dir.entryList(QStringList() << "console-*.journal", QDir::Files, QDir::Name))
+    {
+        files.append(dir.absoluteFilePath(name));
+    }
+
+    return files;
+}
+
+QVector<ConsoleLine> ConsoleJournal::restore(const QString &directory, int maxSegments, int maxLines)
+{
+    QVector<ConsoleLine> lines;
+
+    if(maxSegments <= 0 || maxLines <= 0)
+        return lines;
+
+    QStringList files = segmentFiles(directory);
+    while(files.size() > maxSegments)
+        files.removeFirst();
+
+    // walk only the record headers, newest segment first, until enough lines are found
+    QStringList picked;
+    QList<QVector<qint64> > offsets;
+    int total = 0;
+
+    for(int i = files.size() - 1; i >= 0 && total < maxLines; i--)
+    {
+        JournalReader reader(files.at(i));
+        if(!reader.open())
+            continue;
+
+        QVector<qint64> segmentOffsets;
+        JournalRecord record;
+        qint64 position = reader.position();
+
+        while(reader.next(record))
+        {
+            segmentOffsets.append(position);
+            position = reader.position();
+        }
+
+        int keep = qMin(segmentOffsets.size(), maxLines - total);
+        segmentOffsets.remove(0, segmentOffsets.size() - keep);
+        total += keep;
+
+        picked.prepend(files.at(i));
+        offsets.prepend(segmentOffsets);
+    }
+
+    // then decode just the lines that are kept
+    lines.reserve(total);
+
+    for(int i = 0; i < picked.size(); i++)
+    {
+        JournalReader reader(picked.at(i));
+        if(!reader.open())
+            continue;
+
+        foreach(qint64 offset, offsets.at(i))
+        {
+            JournalRecord record;
+
+            reader.seek(offset);
+            if(!reader.next(record))
+                break;
+
+            ConsoleLine line;
+            line.text = QString::fromUtf8(record.text, record.textSize);
+            line.sequence = record.sequence;
+            line.timestamp = record.timestamp;
+            line.event = record.event;
+            line.event.messageLength = line.text.size() - line.event.messageOffset;
+            line.style = record.style;
+            lines.append(line);
+        }
+    }
+
+    return lines;
+}
+
+bool ConsoleJournal::openSegment(int index)
+{
+    if(m_file.isOpen())
+    {
+        m_file.flush();
+        m_file.close();
+    }
+
+    m_file.setFileName(QDir(m_directory).absoluteFilePath(QString("console-%1.journal").arg(index, 8, 10, QChar('0'))));
+
+    if(!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    m_file.write(JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE);
+    m_segmentIndex = index;
+
+    removeOldSegments();
+    m_flushTimer.start();
+
+    return true;
+}
+
+void ConsoleJournal::removeOldSegments()
+{
+    QStringList files = segmentFiles(m_directory);
+
+    while(files.size() > m_maxSegments)
+    {
+        QFile::remove(files.takeFirst());
+    }
+}
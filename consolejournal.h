@@ -0,0 +1,111 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLEJOURNAL_H
+#define CONSOLEJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QStringList>
+#include <QVector>
+
+#include "consolebuffer.h"
+#include "logevent.h"
+
+// One record as stored in a journal segment. text points into the
+// mapped segment and stays valid as long as its JournalReader.
+struct JournalRecord
+{
+    quint64 sequence;
+    qint64 timestamp;   // msecs since epoch when the line was read
+    LogEvent event;     // messageLength in bytes of text
+    quint8 style;
+    const char* text;   // UTF-8, not terminated
+    int textSize;
+};
+
+// Read side of one journal segment, the file is memory-mapped.
+class JournalReader
+{
+public:
+    explicit JournalReader(const QString& fileName);
+    ~JournalReader();
+
+    bool open();
+    void close();
+
+    qint64 position() const {return m_position;}
+    void seek(qint64 position) {m_position = position;}
+
+    // false at the end of the segment or at a torn record
+    bool next(JournalRecord& record);
+
+private:
+    Q_DISABLE_COPY(JournalReader)
+
+    QFile m_file;
+    const uchar* m_data;
+    qint64 m_size;
+    qint64 m_position;
+};
+
+// Appends console lines to segmented journal files, so the scrollback
+// survives restarts. Lives on the server I/O thread.
+class ConsoleJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConsoleJournal(QObject *parent = 0);
+    ~ConsoleJournal();
+
+    bool open(const QString& directory, qint64 segmentSize, int maxSegments);
+    void close();
+    bool isOpen() const {return m_file.isOpen();}
+
+    // text is the line as read, in UTF-8
+    void append(const ConsoleLine& line, const char* text, int size);
+
+    // sequence after the last record found or written
+    quint64 nextSequence() const {return m_nextSequence;}
+
+    // segment files in directory, oldest first
+    static QStringList segmentFiles(const QString& directory);
+
+    // newest maxLines lines from the last maxSegments segments, oldest first
+    static QVector<ConsoleLine> restore(const QString& directory, int maxSegments, int maxLines);
+
+public slots:
+    void flush();
+
+private:
+    bool openSegment(int index);
+    void removeOldSegments();
+
+    QString m_directory;
+    qint64 m_segmentSize;
+    int m_maxSegments;
+    int m_segmentIndex;
+    quint64 m_nextSequence;
+
+    QFile m_file;
+    QByteArray m_record;
+    QTimer m_flushTimer;
+};
+
+#endif // CONSOLEJOURNAL_H
@@ -0,0 +1,207 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consolemodel.h"
+#include "consolestyle.h"
+
+#include <QRegularExpression>
+#include <QDateTime>
+#include <QBrush>
+#include <QColor>
+
+ConsoleModel::ConsoleModel(QObject *parent) :
+    QAbstractListModel(parent)
+{
+    m_foregrounds.resize(ConsoleStyle::StyleCount);
+
+    for(int style = ConsoleStyle::Quiet; style < ConsoleStyle::StyleCount; style++)
+    {
+        m_foregrounds[style] = QBrush(QColor(QLatin1String(ConsoleStyle::colorName(style))));
+    }
+}
+
+int ConsoleModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return m_buffer.size();
+}
+
+QVariant ConsoleModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row() >= m_buffer.size())
+        return QVariant();
+
+    const ConsoleLine& line = m_buffer.at(index.row());
+
+    switch(role)
+    {
+        case Qt::DisplayRole:
+        case Qt::ToolTipRole:
+            return line.text;
+        case Qt::ForegroundRole:
+            return m_foregrounds.value(line.style);
+        case LevelRole:
+            return int(line.event.level);
+        case ChannelRole:
+            return int(line.event.channel);
+        case TimeRole:
+            return int(line.event.time);
+        case StyleRole:
+            return int(line.style);
+        default:
+            return QVariant();
+    }
+}
+
+void ConsoleModel::setCapacity(int capacity)
+{
+    beginResetModel();
+    m_buffer.setCapacity(capacity);
+    m_index.removeBefore(m_buffer.firstSequence());
+    endResetModel();
+}
+
+void ConsoleModel::appendLines(const QVector<ConsoleLine> &lines)
+{
+    if(lines.isEmpty())
+        return;
+
+    // only the newest lines that fit are kept
+    int capacity = m_buffer.capacity();
+    int count = qMin(lines.size(), capacity);
+    int first = lines.size() - count;
+    int drop = qMax(0, m_buffer.size() + count - capacity);
+
+    if(drop > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, drop - 1);
+        m_buffer.removeFirst(drop);
+        m_index.removeBefore(m_buffer.firstSequence());
+        endRemoveRows();
+    }
+
+    int row = m_buffer.size();
+
+    if(m_buffer.isEmpty())
+        m_index.clear(lines.at(first).sequence);
+
+    beginInsertRows(QModelIndex(), row, row + count - 1);
+    for(int i = first; i < lines.size(); i++)
+    {
+        m_buffer.append(lines.at(i));
+        m_index.addLine(m_buffer.nextSequence() - 1, lines.at(i).text);
+    }
+    endInsertRows();
+}
+
+void ConsoleModel::appendMessage(const QString &text, int style)
+{
+    ConsoleLine line;
+    line.text = text;
+    line.sequence = m_buffer.nextSequence();
+    line.timestamp = QDateTime::currentMSecsSinceEpoch();
+    line.style = quint8(style);
+    line.event.channel = LogEvent::ChannelApplication;
+    line.event.messageLength = text.size();
+
+    appendLine(line);
+}
+
+void ConsoleModel::clear()
+{
+    beginResetModel();
+    m_buffer.clear();
+    m_index.clear(m_buffer.nextSequence());
+    endResetModel();
+}
+
+QVector<quint64> ConsoleModel::search(const QString &pattern, bool regex) const
+{
+    QVector<quint64> hits;
+
+    if(pattern.isEmpty())
+        return hits;
+
+    QRegularExpression expression;
+    QString literal = pattern;
+
+    if(regex)
+    {
+        expression = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
+        if(!expression.isValid())
+            return hits;
+
+        literal = ConsoleSearchIndex::requiredLiteral(pattern);
+    }
+
+    QVector<quint64> candidates;
+    bool indexed = m_index.candidates(literal, candidates);
+
+    if(!indexed)
+    {
+        // too short to narrow down, every line is a candidate
+        candidates.reserve(m_buffer.size());
+        for(int row = 0; row < m_buffer.size(); row++)
+        {
+            candidates.append(m_buffer.at(row).sequence);
+        }
+    }
+
+    foreach(quint64 sequence, candidates)
+    {
+        int row = rowForSequence(sequence);
+        if(row < 0)
+            continue;
+
+        const QString& text = m_buffer.at(row).text;
+
+        if(regex ? expression.match(text).hasMatch() : text.contains(pattern, Qt::CaseInsensitive))
+            hits.append(sequence);
+    }
+
+    return hits;
+}
+
+int ConsoleModel::rowForSequence(quint64 sequence) const
+{
+    int row = m_buffer.indexOf(sequence);
+
+    if(row >= m_buffer.size() || m_buffer.at(row).sequence != sequence)
+        return -1;
+
+    return row;
+}
+
+void ConsoleModel::appendLine(const ConsoleLine &line)
+{
+    if(m_buffer.size() == m_buffer.capacity())
+    {
+        beginRemoveRows(QModelIndex(), 0, 0);
+        m_buffer.removeFirst(1);
+        m_index.removeBefore(m_buffer.firstSequence());
+        endRemoveRows();
+    }
+
+    int row = m_buffer.size();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_buffer.append(line);
+    m_index.addLine(m_buffer.nextSequence() - 1, line.text);
+    endInsertRows();
+}
@@ -0,0 +1,65 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLEMODEL_H
+#define CONSOLEMODEL_H
+
+#include <QAbstractListModel>
+
+#include "consolebuffer.h"
+#include "consolesearchindex.h"
+
+class ConsoleModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles
+    {
+        LevelRole = Qt::UserRole + 1,
+        ChannelRole,
+        TimeRole,
+        StyleRole
+    };
+
+    explicit ConsoleModel(QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    const ConsoleBuffer& buffer() const {return m_buffer;}
+    void setCapacity(int capacity);
+
+    void appendLines(const QVector<ConsoleLine>& lines);
+    void appendMessage(const QString& text, int style);
+    void clear();
+
+    // sequence numbers of the matching lines, oldest first
+    QVector<quint64> search(const QString& pattern, bool regex) const;
+    int rowForSequence(quint64 sequence) const;
+
+private:
+    void appendLine(const ConsoleLine& line);
+
+    ConsoleBuffer m_buffer;
+    ConsoleSearchIndex m_index;
+
+    // Qt::ForegroundRole data per ConsoleStyle, invalid for Plain
+    QVector<QVariant> m_foregrounds;
+};
+
+#endif // CONSOLEMODEL_H
@@ -0,0 +1,245 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consolesearchindex.h"
+
+#include <algorithm>
+
+// dropped lines are purged from the postings once this many piled up
+#define MIN_COMPACT_LINES 4096
+
+static quint64 trigramKey(const QChar* text)
+{
+    return (quint64(text[0].toCaseFolded().unicode()) << 32) |
+           (quint64(text[1].toCaseFolded().unicode()) << 16) |
+            quint64(text[2].toCaseFolded().unicode());
+}
+
+static bool sizeLess(const QVector<quint32>* a, const QVector<quint32>* b)
+{
+    return a->size() < b->size();
+}
+
+ConsoleSearchIndex::ConsoleSearchIndex()
+{
+    m_base = 0;
+    m_first = 0;
+    m_next = 0;
+    m_dropped = 0;
+}
+
+void ConsoleSearchIndex::addLine(quint64 sequence, const QString &text)
+{
+    quint32 offset = quint32(sequence - m_base);
+    const QChar* data = text.constData();
+
+    for(int i = 0; i + 3 <= text.size(); i++)
+    {
+        QVector<quint32>& posting = m_postings[trigramKey(data + i)];
+
+        // lines come in order, so a repeated trigram is always last
+        if(posting.isEmpty() || posting.last() != offset)
+            posting.append(offset);
+    }
+
+    m_next = sequence + 1;
+}
+
+void ConsoleSearchIndex::removeBefore(quint64 sequence)
+{
+    if(sequence <= m_first)
+        return;
+
+    m_dropped += sequence - m_first;
+    m_first = sequence;
+
+    // postings are only trimmed now and then, lookups skip old entries
+    if(m_dropped >= qMax(quint64(MIN_COMPACT_LINES), m_next - m_first))
+        compact();
+}
+
+void ConsoleSearchIndex::clear(quint64 nextSequence)
+{
+    m_postings.clear();
+    m_base = nextSequence;
+    m_first = nextSequence;
+    m_next = nextSequence;
+    m_dropped = 0;
+}
+
+bool ConsoleSearchIndex::candidates(const QString &literal, QVector<quint64> &result) const
+{
+    if(literal.size() < 3)
+        return false;
+
+    QVector<const QVector<quint32>*> lists;
+
+    for(int i = 0; i + 3 <= literal.size(); i++)
+    {
+        QHash<quint64, QVector<quint32> >::const_iterator it = m_postings.constFind(trigramKey(literal.constData() + i));
+
+        if(it == m_postings.constEnd())
+            return true;
+
+        if(!lists.contains(&it.value()))
+            lists.append(&it.value());
+    }
+
+    // walk the shortest list, probe the others
+    std::sort(lists.begin(), lists.end(), sizeLess);
+
+    quint32 first = quint32(m_first - m_base);
+    const QVector<quint32>& shortest = *lists.first();
+
+    for(const quint32* it = std::lower_bound(shortest.constBegin(), shortest.constEnd(), first);
+        it != shortest.constEnd(); ++it)
+    {
+        bool found = true;
+
+        for(int i = 1; i < lists.size() && found; i++)
+        {
+            found = std::binary_search(lists.at(i)->constBegin(), lists.at(i)->constEnd(), *it);
+        }
+
+        if(found)
+            result.append(m_base + *it);
+    }
+
+    return true;
+}
+
+QString ConsoleSearchIndex::requiredLiteral(const QString &pattern)
+{
+    QString best;
+    QString run;
+    int depth = 0;
+    int size = pattern.size();
+
+    for(int i = 0; i <= size; i++)
+    {
+        bool endRun = true;
+
+        if(i < size)
+        {
+            QChar c = pattern.at(i);
+
+            if(c == '\\')
+            {
+                // escaped punctuation is literal, \d \w \b and friends are not
+                if(i + 1 < size && !pattern.at(i + 1).isLetterOrNumber())
+                {
+                    if(depth == 0)
+                    {
+                        run += pattern.at(i + 1);
+                        endRun = false;
+                    }
+                }
+
+                i++;
+            }
+            else if(c == '[')
+            {
+                i++;
+                if(i < size && pattern.at(i) == '^')
+                    i++;
+                if(i < size && pattern.at(i) == ']')
+                    i++;
+                while(i < size && pattern.at(i) != ']')
+                {
+                    if(pattern.at(i) == '\\')
+                        i++;
+                    i++;
+                }
+            }
+            else if(c == '(')
+            {
+                depth++;
+            }
+            else if(c == ')')
+            {
+                depth = qMax(0, depth - 1);
+            }
+            else if(c == '|')
+            {
+                // top-level alternation, nothing is required
+                if(depth == 0)
+                    return QString();
+            }
+            else if(c == '?' || c == '*' || c == '{')
+            {
+                // the character in front is optional
+                run.chop(1);
+
+                if(c == '{')
+                {
+                    while(i < size && pattern.at(i) != '}')
+                        i++;
+                }
+            }
+            else if(c == '+' || c == '.' || c == '^' || c == '$')
+            {
+            }
+            else if(depth == 0)
+            {
+                run += c;
+                endRun = false;
+            }
+        }
+
+        if(endRun && !run.isEmpty())
+        {
+            if(run.size() > best.size())
+                best = run;
+
+            run.clear();
+        }
+    }
+
+    return best;
+}
+
+void ConsoleSearchIndex::compact()
+{
+    quint32 first = quint32(m_first - m_base);
+
+    QHash<quint64, QVector<quint32> >::iterator it = m_postings.begin();
+    while(it != m_postings.end())
+    {
+        QVector<quint32>& posting = it.value();
+        const quint32* keep = std::lower_bound(posting.constBegin(), posting.constEnd(), first);
+
+        if(keep == posting.constEnd())
+        {
+            it = m_postings.erase(it);
+            continue;
+        }
+
+        // rebase so the offsets stay small
+        QVector<quint32> trimmed;
+        trimmed.reserve(posting.constEnd() - keep);
+        for(; keep != posting.constEnd(); ++keep)
+        {
+            trimmed.append(*keep - first);
+        }
+
+        posting = trimmed;
+        ++it;
+    }
+
+    m_base = m_first;
+    m_dropped = 0;
+}
@@ -0,0 +1,54 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLESEARCHINDEX_H
+#define CONSOLESEARCHINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Case-insensitive trigram index over console lines, keyed by line
+// sequence number. Lines are added as they arrive and dropped together
+// with the ring buffer, a lookup only returns candidates which still
+// have to be checked against the line text.
+class ConsoleSearchIndex
+{
+public:
+    ConsoleSearchIndex();
+
+    void addLine(quint64 sequence, const QString& text);
+    void removeBefore(quint64 sequence);
+    void clear(quint64 nextSequence);
+
+    // false when the literal is too short to narrow anything down
+    bool candidates(const QString& literal, QVector<quint64>& result) const;
+
+    // longest run of plain characters every match of the pattern contains
+    static QString requiredLiteral(const QString& pattern);
+
+private:
+    void compact();
+
+    QHash<quint64, QVector<quint32> > m_postings;
+    quint64 m_base;
+    quint64 m_first;
+    quint64 m_next;
+    quint64 m_dropped;
+};
+
+#endif // CONSOLESEARCHINDEX_H
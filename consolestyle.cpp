@@ -0,0 +1,70 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "consolestyle.h"
+
+struct StyleRule
+{
+    quint8 channels;    // bit mask of LogEvent::Channel
+    quint8 minimumLevel;
+    quint8 maximumLevel;
+    quint8 style;
+};
+
+#define STDOUT (1 << LogEvent::ChannelStandardOutput)
+#define STDERR (1 << LogEvent::ChannelStandardError)
+
+// first match wins
+static const StyleRule styleRules[] =
+{
+    { STDOUT | STDERR, LogEvent::LevelError, LogEvent::LevelFatal, ConsoleStyle::Error },
+    { STDOUT | STDERR, LogEvent::LevelWarn, LogEvent::LevelWarn, ConsoleStyle::Warning },
+    { STDOUT | STDERR, LogEvent::LevelTrace, LogEvent::LevelDebug, ConsoleStyle::Quiet },
+    // stack traces and other unformatted stderr output
+    { STDERR, LogEvent::LevelUnknown, LogEvent::LevelUnknown, ConsoleStyle::Error }
+};
+
+static const char* const colorNames[ConsoleStyle::StyleCount] =
+{
+    "black",
+    "gray",
+    "darkorange",
+    "red",
+    "blue",
+    "red",
+    "green"
+};
+
+quint8 ConsoleStyle::classify(const LogEvent &event)
+{
+    int channel = 1 << event.channel;
+
+    for(size_t i = 0; i < sizeof(styleRules) / sizeof(styleRules[0]); i++)
+    {
+        const StyleRule& rule = styleRules[i];
+
+        if((rule.channels & channel) && event.level >= rule.minimumLevel && event.level <= rule.maximumLevel)
+            return rule.style;
+    }
+
+    return Plain;
+}
+
+const char* ConsoleStyle::colorName(int style)
+{
+    return colorNames[(style >= 0 && style < StyleCount) ? style : Plain];
+}
@@ -0,0 +1,51 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONSOLESTYLE_H
+#define CONSOLESTYLE_H
+
+#include <QtGlobal>
+
+#include "logevent.h"
+
+// How console lines are colored. Server lines are classified once by
+// a small rule table on their parsed fields, application messages
+// pick their style when they are added. The view only looks up the
+// brush ConsoleModel caches for the style, no markup is built or parsed
+// per line. Nothing here needs QtGui, the headless daemon uses it too.
+class ConsoleStyle
+{
+public:
+    enum Style
+    {
+        Plain = 0,
+        Quiet,          // trace and debug output
+        Warning,
+        Error,
+        Notice,         // application status messages
+        Failure,
+        Command,        // commands sent to the server
+        StyleCount
+    };
+
+    static quint8 classify(const LogEvent& event);
+
+    // color name as used by the view and the remote clients' rich text
+    static const char* colorName(int style);
+};
+
+#endif // CONSOLESTYLE_H
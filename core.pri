@@ -0,0 +1,55 @@
+#-------------------------------------------------
+# Qt Minecraft Server
+# Copyleft 2013
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#-------------------------------------------------
+
+# Everything that runs the server without a window: settings, process
+# control, the console pipeline, remote and status servers. QtCore and
+# QtNetwork only, shared by the window and the headless daemon.
+
+QT += network
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+include(console.pri)
+
+# remote payload compression, Windows builds use the zlib inside QtCore
+unix: LIBS += -lz
+
+# memory use on the status endpoint
+win32: LIBS += -lpsapi
+
+SOURCES += \
+    $$PWD/serversettings.cpp \
+    $$PWD/servercontroller.cpp \
+    $$PWD/consoleexporter.cpp \
+    $$PWD/remoteprotocol.cpp \
+    $$PWD/remoteserver.cpp \
+    $$PWD/filetransfer.cpp \
+    $$PWD/logscanner.cpp \
+    $$PWD/statusserver.cpp
+
+HEADERS += \
+    $$PWD/serversettings.h \
+    $$PWD/servercontroller.h \
+    $$PWD/consoleexporter.h \
+    $$PWD/remoteprotocol.h \
+    $$PWD/remoteserver.h \
+    $$PWD/filetransfer.h \
+    $$PWD/logscanner.h \
+    $$PWD/tokenbucket.h \
+    $$PWD/statusserver.h
@@ -0,0 +1,217 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "daemon.h"
+#include "servercontroller.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QStringList>
+
+#ifdef Q_OS_UNIX
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// written by the signal handler, read on the event loop
+static int signalSockets[2] = { -1, -1 };
+
+static void onUnixSignal(int)
+{
+    char byte = 1;
+    ssize_t written = ::write(signalSockets[0], &byte, sizeof(byte));
+    Q_UNUSED(written);
+}
+#endif
+
+Daemon::Daemon(ServerController *controller, QObject *parent) :
+    QObject(parent),
+    m_pController(controller),
+    m_out(stdout),
+    m_err(stderr)
+{
+    m_echo = true;
+    m_quitting = false;
+    m_pInputNotifier = 0;
+    m_pSignalNotifier = 0;
+
+    connect( m_pController, SIGNAL(consoleLines(QVector<ConsoleLine>)), SLOT(onConsoleLines(QVector<ConsoleLine>)) );
+    connect( m_pController, SIGNAL(remoteLogMessage(QString,int)), SLOT(onRemoteLog(QString,int)) );
+    connect( m_pController, SIGNAL(remoteSessionsChanged(int,int)), SLOT(onRemoteSessionsChanged(int,int)) );
+    connect( m_pController, SIGNAL(keyChanged(QByteArray)), SLOT(onKeyChanged(QByteArray)) );
+    connect( m_pController, SIGNAL(started()), SLOT(onStarted()) );
+    connect( m_pController, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onFinished()) );
+}
+
+Daemon::~Daemon()
+{
+#ifdef Q_OS_UNIX
+    if(m_pSignalNotifier)
+    {
+        ::signal(SIGINT, SIG_DFL);
+        ::signal(SIGTERM, SIG_DFL);
+    }
+#endif
+}
+
+bool Daemon::watchSignals()
+{
+#ifdef Q_OS_UNIX
+    if(::socketpair(AF_UNIX, SOCK_STREAM, 0, signalSockets) != 0)
+        return false;
+
+    m_pSignalNotifier = new QSocketNotifier(signalSockets[1], QSocketNotifier::Read, this);
+    connect( m_pSignalNotifier, SIGNAL(activated(int)), SLOT(onSignal()) );
+
+    struct sigaction action;
+    action.sa_handler = onUnixSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    return ::sigaction(SIGINT, &action, 0) == 0 && ::sigaction(SIGTERM, &action, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+bool Daemon::watchStandardInput()
+{
+#ifdef Q_OS_UNIX
+    m_pInputNotifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+    connect( m_pInputNotifier, SIGNAL(activated(int)), SLOT(onStandardInput()) );
+    return true;
+#else
+    // a console handle can't be watched by the event loop
+    return false;
+#endif
+}
+
+void Daemon::onSignal()
+{
+#ifdef Q_OS_UNIX
+    char byte;
+    ssize_t length = ::read(signalSockets[1], &byte, sizeof(byte));
+    Q_UNUSED(length);
+#endif
+
+    shutdown();
+}
+
+void Daemon::shutdown()
+{
+    if(m_pController->state() == QProcess::NotRunning)
+    {
+        qApp->quit();
+        return;
+    }
+
+    if(m_quitting)
+    {
+        log(tr("Waiting for the Minecraft Server to stop"));
+        return;
+    }
+
+    // a starting server is stopped as soon as it runs
+    m_quitting = true;
+    m_pController->stop();
+}
+
+void Daemon::onStarted()
+{
+    if(m_quitting)
+        m_pController->stop();
+}
+
+void Daemon::onFinished()
+{
+    if(m_quitting)
+        qApp->quit();
+}
+
+void Daemon::onStandardInput()
+{
+#ifdef Q_OS_UNIX
+    char buffer[4096];
+    ssize_t length = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+
+    if(length <= 0)
+    {
+        // closed, as under a service manager
+        m_pInputNotifier->setEnabled(false);
+        return;
+    }
+
+    m_input.append(buffer, int(length));
+
+    QStringList commands;
+    int end;
+
+    while((end = m_input.indexOf('\n')) >= 0)
+    {
+        QString command = QString::fromLocal8Bit(m_input.constData(), end).trimmed();
+        m_input.remove(0, end + 1);
+
+        if(!command.isEmpty())
+            commands.append(command);
+    }
+
+    if(commands.isEmpty())
+        return;
+
+    if(m_pController->state() != QProcess::Running)
+    {
+        log(tr("Minecraft Server is not running, command dropped"));
+        return;
+    }
+
+    m_pController->sendCommands(commands);
+#endif
+}
+
+void Daemon::onConsoleLines(const QVector<ConsoleLine> &lines)
+{
+    if(!m_echo)
+        return;
+
+    foreach(const ConsoleLine& line, lines)
+    {
+        m_out << line.text << '\n';
+    }
+
+    m_out.flush();
+}
+
+void Daemon::onRemoteLog(const QString &text, int kind)
+{
+    Q_UNUSED(kind);
+    log(text);
+}
+
+void Daemon::onRemoteSessionsChanged(int sessions, int authenticated)
+{
+    log(tr("Remote Server: %1 connected, %2 verified").arg(sessions).arg(authenticated));
+}
+
+void Daemon::onKeyChanged(const QByteArray &key)
+{
+    log(tr("Connection key: %1").arg(QString::fromLatin1(key)));
+}
+
+void Daemon::log(const QString &text)
+{
+    m_err << QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ") << text << Qt::endl;
+}
@@ -0,0 +1,74 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <QObject>
+#include <QTextStream>
+#include <QSocketNotifier>
+
+#include "consolebuffer.h"
+
+class ServerController;
+
+// Frontend of qtmcserverd. The console goes to stdout, the remote log
+// and the connection key to stderr, lines read from stdin are sent to
+// the server as commands. SIGINT and SIGTERM stop the server the way
+// the stop button does before the daemon exits, so the world is saved.
+class Daemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Daemon(ServerController* controller, QObject *parent = 0);
+    ~Daemon();
+
+    void setEcho(bool echo) {m_echo = echo;}
+
+    // unix only, false when the handlers could not be installed
+    bool watchSignals();
+    bool watchStandardInput();
+
+public slots:
+    void shutdown();
+
+private slots:
+    void onConsoleLines(const QVector<ConsoleLine>& lines);
+    void onRemoteLog(const QString& text, int kind);
+    void onRemoteSessionsChanged(int sessions, int authenticated);
+    void onKeyChanged(const QByteArray& key);
+    void onStarted();
+    void onFinished();
+    void onStandardInput();
+    void onSignal();
+
+private:
+    void log(const QString& text);
+
+    ServerController* m_pController;
+    QTextStream m_out;
+    QTextStream m_err;
+    bool m_echo;
+    bool m_quitting;
+
+    QSocketNotifier* m_pInputNotifier;
+    QSocketNotifier* m_pSignalNotifier;
+    QByteArray m_input;
+};
+
+#endif // DAEMON_H
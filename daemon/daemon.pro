@@ -0,0 +1,37 @@
+#-------------------------------------------------
+# Qt Minecraft Server
+# Copyleft 2013
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+#-------------------------------------------------
+
+# Headless qtmcserver: the core without widgets, runs under
+# QCoreApplication and needs no display.
+#   qmake daemon/daemon.pro && make
+
+QT       += core network
+QT       -= gui
+
+TARGET = qtmcserverd
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../core.pri)
+
+SOURCES += main.cpp \
+    daemon.cpp
+
+HEADERS += daemon.h
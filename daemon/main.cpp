@@ -0,0 +1,85 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// qtmcserverd runs the Minecraft server, its console journal and the
+// remote and status servers without a window, from the same settings
+// file the window uses. Settings given on the command line are not
+// saved.
+
+#include "daemon.h"
+#include "servercontroller.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless Qt Minecraft Server");
+    parser.addHelpOption();
+
+    QCommandLineOption serverOption("server", "Minecraft server jar or bat file, instead of the one in the settings.", "file");
+    QCommandLineOption startOption("start", "Start the Minecraft server right away, not only when a remote client asks.");
+    QCommandLineOption noRemoteOption("no-remote", "Don't listen for remote clients.");
+    QCommandLineOption remotePortOption("remote-port", "Remote control port.", "port");
+    QCommandLineOption statusPortOption("status-port", "Status endpoint port, 0 for none.", "port");
+    QCommandLineOption quietOption("quiet", "Don't copy the console to stdout.");
+
+    parser.addOption(serverOption);
+    parser.addOption(startOption);
+    parser.addOption(noRemoteOption);
+    parser.addOption(remotePortOption);
+    parser.addOption(statusPortOption);
+    parser.addOption(quietOption);
+    parser.process(app);
+
+    ServerController controller;
+    ServerSettings& settings = controller.settings();
+
+    if(parser.isSet(serverOption))
+        settings.mcServerPath = QFileInfo(parser.value(serverOption)).absoluteFilePath();
+
+    if(parser.isSet(remotePortOption))
+        settings.remotePort = parser.value(remotePortOption).toInt();
+
+    if(parser.isSet(statusPortOption))
+        settings.statusPort = parser.value(statusPortOption).toInt();
+
+    Daemon daemon(&controller);
+    daemon.setEcho(!parser.isSet(quietOption));
+    daemon.watchSignals();
+    daemon.watchStandardInput();
+
+    controller.initialize();
+
+    if(!parser.isSet(noRemoteOption))
+    {
+        controller.listenRemote();
+        controller.refreshKey();
+    }
+
+    if(parser.isSet(startOption) && !controller.start())
+    {
+        QTextStream(stderr) << "No Minecraft server file, set one with --server or in the window's settings" << Qt::endl;
+        return 2;
+    }
+
+    return app.exec();
+}
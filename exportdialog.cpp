@@ -0,0 +1,66 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exportdialog.h"
+#include "ui_exportdialog.h"
+#include "loglineparser.h"
+
+#include <QDateTime>
+
+ExportDialog::ExportDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::ExportDialog)
+{
+    ui->setupUi(this);
+
+    ui->levelComboBox->addItem(tr("All lines"), int(LogEvent::LevelUnknown));
+    for(int level = LogEvent::LevelTrace; level <= LogEvent::LevelFatal; level++)
+    {
+        ui->levelComboBox->addItem(tr("%1 and above").arg(LogLineParser::levelName(level)), level);
+    }
+
+    QDateTime now = QDateTime::currentDateTime();
+    ui->fromDateTimeEdit->setDateTime(now.addDays(-1));
+    ui->toDateTimeEdit->setDateTime(now);
+
+    on_timeRangeCheckBox_toggled(false);
+}
+
+ExportDialog::~ExportDialog()
+{
+    delete ui;
+}
+
+ExportFilter ExportDialog::filter() const
+{
+    ExportFilter filter;
+    filter.minimumLevel = ui->levelComboBox->itemData(ui->levelComboBox->currentIndex()).toInt();
+
+    if(ui->timeRangeCheckBox->isChecked())
+    {
+        filter.from = ui->fromDateTimeEdit->dateTime().toMSecsSinceEpoch();
+        filter.to = ui->toDateTimeEdit->dateTime().toMSecsSinceEpoch();
+    }
+
+    return filter;
+}
+
+void ExportDialog::on_timeRangeCheckBox_toggled(bool checked)
+{
+    ui->fromDateTimeEdit->setEnabled(checked);
+    ui->toDateTimeEdit->setEnabled(checked);
+}
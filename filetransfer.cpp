@@ -0,0 +1,143 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "filetransfer.h"
+
+#include <QFileInfo>
+
+// the part in front of the range is hashed this much at a time
+#define HASH_STEP (1024 * 1024)
+
+FileTransfer::FileTransfer() :
+    m_hash(QCryptographicHash::Sha256)
+{
+    m_data = 0;
+    m_size = 0;
+    m_offset = 0;
+    m_end = 0;
+    m_position = 0;
+    m_hashed = 0;
+}
+
+FileTransfer::~FileTransfer()
+{
+    close();
+}
+
+bool FileTransfer::open(const QString &fileName, qint64 offset, qint64 length, bool closed)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if(fileName.isEmpty() || !m_file.open(QIODevice::ReadOnly))
+    {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    // a log that keeps growing is sent as it was when the transfer started
+    m_size = m_file.size();
+
+    if(offset < 0 || offset > m_size)
+    {
+        m_errorString = QString("offset %1 is past the end (%2)").arg(offset).arg(m_size);
+        close();
+        return false;
+    }
+
+    m_offset = offset;
+    m_end = (length < 0) ? m_size : qMin(m_size, offset + length);
+    m_position = offset;
+
+    // without a mapping the file is read in chunks instead
+    if(closed && m_end > 0)
+        m_data = m_file.map(0, m_end);
+
+    return true;
+}
+
+void FileTransfer::close()
+{
+    if(m_data)
+    {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = 0;
+    }
+
+    m_file.close();
+    m_hash.reset();
+    m_size = 0;
+    m_offset = 0;
+    m_end = 0;
+    m_position = 0;
+    m_hashed = 0;
+}
+
+QString FileTransfer::fileName() const
+{
+    return QFileInfo(m_file.fileName()).fileName();
+}
+
+QByteArray FileTransfer::read(int maxSize)
+{
+    int size = int(qMin(qint64(maxSize), m_end - m_position));
+    if(size <= 0)
+        return QByteArray();
+
+    QByteArray chunk = bytes(m_position, size);
+    m_position += chunk.size();
+
+    // keeps the checksum close behind, checksum() has less left to do
+    hash(qMin(m_position, m_hashed + size + HASH_STEP));
+
+    // the file got shorter while sending
+    if(chunk.isEmpty())
+        m_end = m_position;
+
+    return chunk;
+}
+
+QByteArray FileTransfer::checksum()
+{
+    hash(m_end);
+    return m_hash.result();
+}
+
+QByteArray FileTransfer::bytes(qint64 position, int size)
+{
+    if(m_data)
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(m_data + position), size);
+
+    if(!m_file.seek(position))
+        return QByteArray();
+
+    return m_file.read(size);
+}
+
+void FileTransfer::hash(qint64 end)
+{
+    while(m_hashed < end)
+    {
+        QByteArray chunk = bytes(m_hashed, int(qMin(qint64(HASH_STEP), end - m_hashed)));
+        if(chunk.isEmpty())
+            break;
+
+        m_hash.addData(chunk);
+        m_hashed += chunk.size();
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILETRANSFER_H
+#define FILETRANSFER_H
+
+#include <QFile>
+#include <QCryptographicHash>
+
+// Sends a byte range of a file. A closed file is memory-mapped when the
+// platform allows it, chunks then point straight into the mapping and
+// are only copied once, into the socket's buffer. A file that is still
+// being written is read instead: truncated under a mapping, touching the
+// lost pages would raise SIGBUS.
+class FileTransfer
+{
+public:
+    FileTransfer();
+    ~FileTransfer();
+
+    // length -1 runs to the end of the file as it is now, only a closed
+    // file is mapped
+    bool open(const QString& fileName, qint64 offset, qint64 length, bool closed);
+    void close();
+    bool isOpen() const {return m_file.isOpen();}
+
+    QString fileName() const;
+    QString errorString() const {return m_errorString;}
+
+    qint64 fileSize() const {return m_size;}
+    qint64 offset() const {return m_offset;}
+    qint64 length() const {return m_end - m_offset;}
+    bool atEnd() const {return m_position >= m_end;}
+
+    // next part of the range, valid until the next call
+    QByteArray read(int maxSize);
+
+    // SHA-256 of the file from its start to the end of the range, so a
+    // download resumed at offset can be checked as a whole
+    QByteArray checksum();
+
+private:
+    Q_DISABLE_COPY(FileTransfer)
+
+    QByteArray bytes(qint64 position, int size);
+    void hash(qint64 end);
+
+    QFile m_file;
+    const uchar* m_data;
+    qint64 m_size;
+    qint64 m_offset;
+    qint64 m_end;
+    qint64 m_position;
+    qint64 m_hashed;
+    QCryptographicHash m_hash;
+    QString m_errorString;
+};
+
+#endif // FILETRANSFER_H
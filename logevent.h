@@ -0,0 +1,64 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGEVENT_H
+#define LOGEVENT_H
+
+#include <QtGlobal>
+
+// Typed fields of one console line, filled by LogLineParser.
+// The message offsets index the line text, the prefix in front of the
+// message is plain ASCII so byte and character offsets are the same.
+struct LogEvent
+{
+    enum Level
+    {
+        LevelUnknown = 0,
+        LevelTrace,
+        LevelDebug,
+        LevelInfo,
+        LevelWarn,
+        LevelError,
+        LevelFatal
+    };
+
+    enum Channel
+    {
+        ChannelStandardOutput = 0,
+        ChannelStandardError,
+        ChannelApplication
+    };
+
+    LogEvent() :
+        time(-1),
+        thread(0),
+        level(LevelUnknown),
+        channel(ChannelStandardOutput),
+        messageOffset(0),
+        messageLength(0)
+    {
+    }
+
+    qint32 time;            // seconds since midnight, -1 when the line has none
+    quint16 thread;         // interned thread name, 0 when the line has none
+    quint8 level;           // Level
+    quint8 channel;         // Channel
+    qint32 messageOffset;
+    qint32 messageLength;   // characters of the line text, bytes until the line is decoded
+};
+
+#endif // LOGEVENT_H
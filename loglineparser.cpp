@@ -0,0 +1,255 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "loglineparser.h"
+
+#include <string.h>
+
+// thread names past this many distinct ones are not interned
+#define MAX_THREAD_NAMES 4096
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static bool isAscii(const char* data, int size)
+{
+    for(int i = 0; i < size; i++)
+    {
+        if(uchar(data[i]) >= 0x80)
+            return false;
+    }
+
+    return true;
+}
+
+static bool equals(const char* data, int size, const char* token)
+{
+    return size == int(qstrlen(token)) && memcmp(data, token, size) == 0;
+}
+
+// HH:MM:SS
+static bool parseClock(const char* data, const char* end, qint32& time)
+{
+    if(end - data < 8)
+        return false;
+
+    if(!isDigit(data[0]) || !isDigit(data[1]) || data[2] != ':' ||
+       !isDigit(data[3]) || !isDigit(data[4]) || data[5] != ':' ||
+       !isDigit(data[6]) || !isDigit(data[7]))
+        return false;
+
+    int hours = (data[0] - '0') * 10 + (data[1] - '0');
+    int minutes = (data[3] - '0') * 10 + (data[4] - '0');
+    int seconds = (data[6] - '0') * 10 + (data[7] - '0');
+
+    if(hours > 23 || minutes > 59 || seconds > 60)
+        return false;
+
+    time = hours * 3600 + minutes * 60 + seconds;
+    return true;
+}
+
+static const char* findByte(const char* data, const char* end, char c)
+{
+    return static_cast<const char*>(memchr(data, c, end - data));
+}
+
+LogLineParser::LogLineParser()
+{
+    m_lastThreadId = 0;
+}
+
+void LogLineParser::parse(const char *data, int size, LogEvent &event)
+{
+    const char* end = data + size;
+    const char* p = data;
+    const char* threadName = 0;
+    int threadSize = 0;
+    qint32 time = -1;
+    LogEvent::Level lineLevel = LogEvent::LevelUnknown;
+
+    event.time = -1;
+    event.thread = 0;
+    event.level = LogEvent::LevelUnknown;
+    event.messageOffset = 0;
+    event.messageLength = size;
+
+    if(size > 0 && *p == '[')
+    {
+        if(!parseClock(p + 1, end, time))
+            return;
+
+        p += 9;
+
+        if(p < end && *p == ']')
+        {
+            // [12:34:56] [Server thread/INFO]: message
+            p++;
+
+            if(end - p < 2 || p[0] != ' ' || p[1] != '[')
+                return;
+
+            p += 2;
+
+            const char* close = findByte(p, end, ']');
+            if(!close)
+                return;
+
+            const char* slash = close;
+            while(slash > p && *slash != '/')
+                slash--;
+
+            if(*slash != '/' || !isAscii(p, close - p))
+                return;
+
+            threadName = p;
+            threadSize = slash - p;
+            lineLevel = level(slash + 1, close - slash - 1);
+            p = close + 1;
+        }
+        else if(p < end && *p == ' ')
+        {
+            // [12:34:56 INFO]: message
+            p++;
+
+            const char* close = findByte(p, end, ']');
+            if(!close || !isAscii(p, close - p))
+                return;
+
+            lineLevel = level(p, close - p);
+            p = close + 1;
+        }
+        else
+        {
+            return;
+        }
+
+        if(p < end && *p == ':')
+            p++;
+    }
+    else if(size >= 22 && isDigit(data[0]) && data[4] == '-' && data[7] == '-' && data[10] == ' ')
+    {
+        // 2013-06-01 12:34:56 [INFO] message
+        if(!parseClock(data + 11, end, time))
+            return;
+
+        p = data + 19;
+
+        if(p[0] != ' ' || p[1] != '[')
+            return;
+
+        p += 2;
+
+        const char* close = findByte(p, end, ']');
+        if(!close || !isAscii(p, close - p))
+            return;
+
+        lineLevel = level(p, close - p);
+        p = close + 1;
+    }
+    else
+    {
+        return;
+    }
+
+    if(p < end && *p == ' ')
+        p++;
+
+    event.time = time;
+    event.thread = threadName ? internThread(threadName, threadSize) : 0;
+    event.level = lineLevel;
+    event.messageOffset = p - data;
+    event.messageLength = end - p;
+}
+
+QString LogLineParser::threadName(quint16 thread) const
+{
+    QReadLocker locker(&m_namesLock);
+
+    if(thread == 0 || thread > m_threadNames.size())
+        return QString();
+
+    return m_threadNames.at(thread - 1);
+}
+
+LogEvent::Level LogLineParser::level(const char *data, int size)
+{
+    if(equals(data, size, "INFO"))
+        return LogEvent::LevelInfo;
+    if(equals(data, size, "WARN") || equals(data, size, "WARNING"))
+        return LogEvent::LevelWarn;
+    if(equals(data, size, "ERROR") || equals(data, size, "SEVERE"))
+        return LogEvent::LevelError;
+    if(equals(data, size, "FATAL"))
+        return LogEvent::LevelFatal;
+    if(equals(data, size, "DEBUG"))
+        return LogEvent::LevelDebug;
+    if(equals(data, size, "TRACE"))
+        return LogEvent::LevelTrace;
+
+    return LogEvent::LevelUnknown;
+}
+
+const char* LogLineParser::levelName(int level)
+{
+    switch(level)
+    {
+        case LogEvent::LevelTrace:
+            return "TRACE";
+        case LogEvent::LevelDebug:
+            return "DEBUG";
+        case LogEvent::LevelInfo:
+            return "INFO";
+        case LogEvent::LevelWarn:
+            return "WARN";
+        case LogEvent::LevelError:
+            return "ERROR";
+        case LogEvent::LevelFatal:
+            return "FATAL";
+        default:
+            return "";
+    }
+}
+
+quint16 LogLineParser::internThread(const char *data, int size)
+{
+    // nearly every line comes from the same thread as the one before
+    if(m_lastThreadId && m_lastThread.size() == size && memcmp(m_lastThread.constData(), data, size) == 0)
+        return m_lastThreadId;
+
+    QByteArray name(data, size);
+    quint16 id = m_threadIds.value(name, 0);
+
+    if(id == 0)
+    {
+        if(m_threadIds.size() >= MAX_THREAD_NAMES)
+            return 0;
+
+        id = quint16(m_threadIds.size() + 1);
+        m_threadIds.insert(name, id);
+
+        QWriteLocker locker(&m_namesLock);
+        m_threadNames.append(QString::fromLatin1(name));
+    }
+
+    m_lastThread = name;
+    m_lastThreadId = id;
+
+    return id;
+}
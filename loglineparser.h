@@ -0,0 +1,58 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGLINEPARSER_H
+#define LOGLINEPARSER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QReadWriteLock>
+
+#include "logevent.h"
+
+// Scans raw console lines in place, nothing is allocated per field.
+// Understands the formats written by the Minecraft server:
+//   [12:34:56] [Server thread/INFO]: message     (1.7 and later)
+//   [12:34:56 INFO]: message                     (Bukkit, Spigot, Paper)
+//   2013-06-01 12:34:56 [INFO] message           (1.6 and earlier)
+// Lines in any other shape are kept whole as an unknown level message.
+class LogLineParser
+{
+public:
+    LogLineParser();
+
+    // parse() is meant for one thread, threadName() for any thread
+    void parse(const char* data, int size, LogEvent& event);
+    QString threadName(quint16 thread) const;
+
+    static LogEvent::Level level(const char* data, int size);
+    static const char* levelName(int level);
+
+private:
+    quint16 internThread(const char* data, int size);
+
+    QHash<QByteArray, quint16> m_threadIds;
+    QByteArray m_lastThread;
+    quint16 m_lastThreadId;
+
+    mutable QReadWriteLock m_namesLock;
+    QVector<QString> m_threadNames;
+};
+
+#endif // LOGLINEPARSER_H
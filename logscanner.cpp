@@ -0,0 +1,240 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "logscanner.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include <string.h>
+
+#define INFLATE_CHUNK_SIZE (64 * 1024)
+
+#define MSECS_PER_DAY (24 * 3600 * qint64(1000))
+
+LogScanner::LogScanner()
+{
+    m_pStream = 0;
+    m_atEnd = true;
+    m_day = 0;
+    m_lastTime = -1;
+    m_lineTime = -1;
+    m_keepContinuation = true;
+    m_scanned = 0;
+    m_matched = 0;
+}
+
+LogScanner::~LogScanner()
+{
+    close();
+}
+
+bool LogScanner::open(const QString &fileName, const LogFilter &filter)
+{
+    close();
+
+    m_scanned = 0;
+    m_matched = 0;
+
+    m_file.setFileName(fileName);
+    if(!m_file.open(QIODevice::ReadOnly))
+    {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    if(fileName.endsWith(".gz"))
+    {
+        m_pStream = new z_stream;
+        memset(m_pStream, 0, sizeof(z_stream));
+
+        // 16 selects the gzip wrapper
+        if(inflateInit2(m_pStream, 16 + MAX_WBITS) != Z_OK)
+        {
+            delete m_pStream;
+            m_pStream = 0;
+            m_errorString = "zlib failed to start";
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_filter = filter;
+    m_matcher.setPattern(filter.text.toUtf8());
+    m_atEnd = false;
+
+    // archives are named 2013-06-01-1.log.gz, latest.log is from its last change
+    QFileInfo info(fileName);
+    QDate date = QDate::fromString(info.fileName().left(10), "yyyy-MM-dd");
+    if(!date.isValid())
+        date = info.lastModified().date();
+
+    m_day = QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch();
+    m_lastTime = -1;
+    m_lineTime = -1;
+    m_keepContinuation = true;
+
+    return true;
+}
+
+void LogScanner::close()
+{
+    if(m_pStream)
+    {
+        inflateEnd(m_pStream);
+        delete m_pStream;
+        m_pStream = 0;
+    }
+
+    m_file.close();
+    m_pending.clear();
+    m_atEnd = true;
+}
+
+bool LogScanner::scan(int maxInput, QStringList &lines)
+{
+    if(m_atEnd)
+        return true;
+
+    QByteArray input = m_file.read(maxInput);
+
+    if(m_pStream)
+    {
+        if(!inflate(input))
+        {
+            close();
+            return false;
+        }
+    }
+    else
+    {
+        m_pending.append(input);
+    }
+
+    bool end = m_file.atEnd() || input.isEmpty();
+    scanLines(end, lines);
+
+    if(end)
+        close();
+
+    return true;
+}
+
+bool LogScanner::inflate(const QByteArray &input)
+{
+    m_pStream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.constData()));
+    m_pStream->avail_in = uInt(input.size());
+
+    do
+    {
+        int size = m_pending.size();
+        m_pending.resize(size + INFLATE_CHUNK_SIZE);
+
+        m_pStream->next_out = reinterpret_cast<Bytef*>(m_pending.data() + size);
+        m_pStream->avail_out = INFLATE_CHUNK_SIZE;
+
+        int result = ::inflate(m_pStream, Z_NO_FLUSH);
+
+        m_pending.resize(m_pending.size() - int(m_pStream->avail_out));
+
+        if(result == Z_STREAM_END)
+        {
+            // a gzip file may hold several members back to back
+            if(inflateReset(m_pStream) != Z_OK)
+                return false;
+        }
+        else if(result != Z_OK && result != Z_BUF_ERROR)
+        {
+            m_errorString = QString("damaged archive (%1)").arg(m_pStream->msg ? m_pStream->msg : "zlib");
+            return false;
+        }
+    }
+    while(m_pStream->avail_in > 0 || m_pStream->avail_out == 0);
+
+    return true;
+}
+
+void LogScanner::scanLines(bool flush, QStringList &lines)
+{
+    const char* data = m_pending.constData();
+    int size = m_pending.size();
+    int start = 0;
+
+    while(start < size)
+    {
+        const char* newline = static_cast<const char*>(memchr(data + start, '\n', size - start));
+        if(!newline && !flush)
+            break;
+
+        int end = newline ? int(newline - data) : size;
+        int length = end - start;
+        if(length > 0 && data[end - 1] == '\r')
+            length--;
+
+        if(accept(data + start, length))
+        {
+            lines.append(QString::fromUtf8(data + start, length));
+            m_matched++;
+        }
+
+        m_scanned++;
+        start = end + 1;
+    }
+
+    m_pending.remove(0, qMin(start, size));
+}
+
+bool LogScanner::accept(const char *data, int size)
+{
+    LogEvent event;
+    m_parser.parse(data, size, event);
+
+    if(event.time >= 0)
+    {
+        // the clock went back a long way, the log ran past midnight
+        if(m_lastTime >= 0 && event.time + 3600 < m_lastTime)
+            m_day += MSECS_PER_DAY;
+
+        m_lastTime = event.time;
+        m_lineTime = m_day + qint64(event.time) * 1000;
+    }
+
+    // stack traces and other continuation lines go with the line they follow
+    if(event.level != LogEvent::LevelUnknown)
+        m_keepContinuation = (event.level >= m_filter.minimumLevel);
+
+    if(m_filter.minimumLevel > LogEvent::LevelUnknown && !m_keepContinuation)
+        return false;
+
+    if(m_lineTime >= 0)
+    {
+        if(m_filter.from >= 0 && m_lineTime < m_filter.from)
+            return false;
+
+        if(m_filter.to >= 0 && m_lineTime > m_filter.to)
+            return false;
+    }
+
+    return m_filter.text.isEmpty() || m_matcher.indexIn(data, size) >= 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LOGSCANNER_H
+#define LOGSCANNER_H
+
+#include <QFile>
+#include <QByteArrayMatcher>
+#include <QStringList>
+
+#include "loglineparser.h"
+
+struct z_stream_s;
+typedef struct z_stream_s z_stream;
+
+// Which lines of a log file a scan keeps.
+struct LogFilter
+{
+    LogFilter() :
+        minimumLevel(LogEvent::LevelUnknown),
+        from(-1),
+        to(-1)
+    {
+    }
+
+    int minimumLevel;   // LogEvent::Level, LevelUnknown keeps every line
+    qint64 from;        // msecs since epoch, -1 for no limit
+    qint64 to;
+    QString text;       // case-sensitive, empty matches every line
+};
+
+// Reads a server log, plain or gzip compressed, a slice at a time and
+// keeps the lines a LogFilter lets through. Lines are only decoded once
+// they passed, the rest is matched on the raw bytes.
+class LogScanner
+{
+public:
+    LogScanner();
+    ~LogScanner();
+
+    bool open(const QString& fileName, const LogFilter& filter);
+    void close();
+    bool isOpen() const {return m_file.isOpen();}
+    bool atEnd() const {return m_atEnd;}
+
+    QString errorString() const {return m_errorString;}
+
+    // reads up to maxInput bytes of the file, false on a damaged archive
+    bool scan(int maxInput, QStringList& lines);
+
+    quint64 scannedLines() const {return m_scanned;}
+    quint64 matchedLines() const {return m_matched;}
+
+private:
+    Q_DISABLE_COPY(LogScanner)
+
+    bool inflate(const QByteArray& input);
+    void scanLines(bool flush, QStringList& lines);
+    bool accept(const char* data, int size);
+
+    QFile m_file;
+    z_stream* m_pStream;
+    bool m_atEnd;
+    QString m_errorString;
+
+    LogFilter m_filter;
+    QByteArrayMatcher m_matcher;
+    LogLineParser m_parser;
+    QByteArray m_pending;
+
+    // log lines carry the time of day only, the day comes from the file
+    qint64 m_day;
+    qint32 m_lastTime;
+    qint64 m_lineTime;
+    bool m_keepContinuation;
+
+    quint64 m_scanned;
+    quint64 m_matched;
+};
+
+#endif // LOGSCANNER_H
@@ -20,12 +20,22 @@
 
 #include "aboutdialog.h"
 #include "settingsdialog.h"
+#include "consolemodel.h"
+#include "consolestyle.h"
+#include "consolejournal.h"
+#include "consoleexporter.h"
+#include "exportdialog.h"
+#include "remoteserver.h"
+#include "servercontroller.h"
 
 #include <QFileDialog>
 #include <QTextStream>
 #include <QDebug>
-#include <QCryptographicHash>
 #include <QClipboard>
+#include <QScrollBar>
+#include <QProgressDialog>
+
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -42,24 +52,40 @@ MainWindow::MainWindow(QWidget *parent) :
     trayIcon = 0;
     trayIconMenu = 0;
 
-    m_pServerProcess = 0;
+    m_pController = 0;
     m_pFileSystemWatcher = 0;
     m_pDirSystemWatcher = 0;
 
-    m_pSettings = 0;
-    m_useCustomJavaPath = false;
-    m_mcServerPath = "";
-    m_customJavaPath = "";
-    m_xms = 512;
-    m_xmx = 512;
-    m_additionalParameters = "";
+    m_pConsoleModel = 0;
+    m_pExportThread = 0;
+    m_pExporter = 0;
+    m_pExportProgress = 0;
+    m_searchHitIndex = 0;
+    m_searchRegex = false;
 
     statusLabel = 0;
     statusLedLabel = 0;
+
+    m_remoteSessions = 0;
 }
 
 MainWindow::~MainWindow()
 {
+    if(m_pExportThread)
+    {
+        m_pExporter->cancel();
+        m_pExportThread->quit();
+        m_pExportThread->wait();
+        m_pExportThread = 0;
+        m_pExporter = 0;
+    }
+
+    if(m_pController)
+    {
+        delete m_pController;
+        m_pController = 0;
+    }
+
     if(m_pDirSystemWatcher)
     {
         delete m_pDirSystemWatcher;
@@ -72,13 +98,40 @@ MainWindow::~MainWindow()
         m_pFileSystemWatcher = 0;
     }
 
-    if(m_pSettings)
+    delete ui;
+}
+
+void MainWindow::appendConsoleLines(const QVector<ConsoleLine> &lines)
+{
+    bool atBottom = isConsoleAtBottom();
+
+    m_pConsoleModel->appendLines(lines);
+
+    if(atBottom)
+        ui->serverLogView->scrollToBottom();
+}
+
+void MainWindow::appendConsoleMessage(const QString &text, int style)
+{
+    if(m_pController && m_pController->serverProcess())
     {
-        delete m_pSettings;
-        m_pSettings = 0;
+        // numbered and journaled in line with the server output, shows up with the next drain
+        m_pController->postMessage(text, style);
+        return;
     }
 
-    delete ui;
+    bool atBottom = isConsoleAtBottom();
+
+    m_pConsoleModel->appendMessage(text, style);
+
+    if(atBottom)
+        ui->serverLogView->scrollToBottom();
+}
+
+bool MainWindow::isConsoleAtBottom()
+{
+    QScrollBar* scrollBar = ui->serverLogView->verticalScrollBar();
+    return scrollBar->value() == scrollBar->maximum();
 }
 
 QString MainWindow::htmlColor(const QString &msg, const QString &color)
@@ -154,12 +207,31 @@ void MainWindow::initialize()
         trayIcon->show();
     }
 
-    m_pServerProcess = new QProcess(this);
+    m_pConsoleModel = new ConsoleModel(this);
+    ui->serverLogView->setModel(m_pConsoleModel);
+
+    QAction* copyAction = new QAction(tr("&Copy"), ui->serverLogView);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setShortcutContext(Qt::WidgetShortcut);
+    connect(copyAction, SIGNAL(triggered()), SLOT(copyConsoleSelection()));
+    ui->serverLogView->addAction(copyAction);
+    ui->serverLogView->setContextMenuPolicy(Qt::ActionsContextMenu);
+
+    // settings, server process and remote server, everything but the widgets
+    m_pController = new ServerController;
 
-    connect( m_pServerProcess, SIGNAL(started()), SLOT(onStart()) );
-    connect( m_pServerProcess, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onFinish(int,QProcess::ExitStatus)) );
-    connect( m_pServerProcess, SIGNAL(readyReadStandardOutput()), SLOT(onStandardOutput()) );
-    connect( m_pServerProcess, SIGNAL(readyReadStandardError()), SLOT(onStandardError()) );
+    connect( m_pController, SIGNAL(aboutToStart()), SLOT(on_actionSaveServerProperties_triggered()) );
+    connect( m_pController, SIGNAL(started()), SLOT(onStart()) );
+    connect( m_pController, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onFinish(int,QProcess::ExitStatus)) );
+    connect( m_pController, SIGNAL(consoleLines(QVector<ConsoleLine>)), SLOT(appendConsoleLines(QVector<ConsoleLine>)) );
+    connect( m_pController, SIGNAL(remoteLogMessage(QString,int)), SLOT(onRemoteLog(QString,int)) );
+    connect( m_pController, SIGNAL(remoteSessionsChanged(int,int)), SLOT(onRemoteSessionsChanged(int,int)) );
+
+    const ServerSettings& settings = m_pController->settings();
+
+    m_pConsoleModel->setCapacity(settings.consoleScrollback);
+
+    m_pController->initialize();
 
     m_pFileSystemWatcher = new QFileSystemWatcher(this);
     connect( m_pFileSystemWatcher, SIGNAL(fileChanged(QString)), SLOT(onWatchedFileChanged(QString)) );
@@ -167,21 +239,17 @@ void MainWindow::initialize()
     m_pDirSystemWatcher = new QFileSystemWatcher(this);
     connect( m_pDirSystemWatcher, SIGNAL(directoryChanged(QString)), SLOT(onWatchedDirChanged(QString)) );
 
-    m_pSettings = new QSettings(QSettings::IniFormat, QSettings::UserScope, "Qt Minecraft Server", "qtmcserver", this);
-
-    loadSettings();
-
-    if(m_mcServerPath.isEmpty())
+    if(settings.mcServerPath.isEmpty())
     {
         on_actionSettings_triggered();
     }
 
     loadServerProperties();
 
-    if(!m_mcServerPath.isEmpty())
+    if(!settings.mcServerPath.isEmpty())
     {
-        updateWatchedFileSystemPath("", getMinecraftServerPropertiesPath(m_mcServerPath));
-        updateWatchedDirSystemPath("", getMinecraftServerWorkingDirectoryPath(m_mcServerPath));
+        updateWatchedFileSystemPath("", getMinecraftServerPropertiesPath(settings.mcServerPath));
+        updateWatchedDirSystemPath("", getMinecraftServerWorkingDirectoryPath(settings.mcServerPath));
     }
     //===2018new===
     ui->CopyButton->setEnabled(false);
@@ -204,44 +272,34 @@ void MainWindow::closeApplication()
 
 void MainWindow::loadSettings()
 {
-    if(m_pSettings)
+    if(m_pController)
     {
-        QString strUseCustomJavaPath = m_pSettings->value("Settings/UseCustomJavaPath", "no").toString();
-        m_useCustomJavaPath = (strUseCustomJavaPath == "yes") ? true : false;
-
-        m_customJavaPath = m_pSettings->value("Settings/CustomJavaPath", "").toString();
-        m_mcServerPath = m_pSettings->value("Settings/MinecraftServerPath", "").toString();
-        m_xms =  m_pSettings->value("Settings/Xms", "512").toInt();
-        m_xmx =  m_pSettings->value("Settings/Xmx", "512").toInt();
-        m_additionalParameters = m_pSettings->value("Settings/AdditionalParameters", "").toString();
+        m_pController->loadSettings();
     }
 }
 
 void MainWindow::saveSettings()
 {
-    if(m_pSettings)
+    if(m_pController)
     {
-        m_pSettings->setValue("Settings/UseCustomJavaPath", m_useCustomJavaPath ? "yes" : "no");
-        m_pSettings->setValue("Settings/CustomJavaPath", m_customJavaPath);
-        m_pSettings->setValue("Settings/MinecraftServerPath", m_mcServerPath);
-        m_pSettings->setValue("Settings/Xms", m_xms);
-        m_pSettings->setValue("Settings/Xmx", m_xmx);
-        m_pSettings->setValue("Settings/AdditionalParameters", m_additionalParameters);
+        m_pController->saveSettings();
     }
 }
 
 void MainWindow::loadServerProperties()
 {
-    if(!m_mcServerPath.isEmpty())
+    QString mcServerPath = m_pController->settings().mcServerPath;
+
+    if(!mcServerPath.isEmpty())
     {
-        if(m_pServerProcess && (m_pServerProcess->state() == QProcess::NotRunning))
+        if(m_pController->state() == QProcess::NotRunning)
         {
             ui->actionSaveServerProperties->setEnabled(true);
         }
 
         ui->serverPropertiesTextEdit->clear();
 
-        QFile file(getMinecraftServerPropertiesPath(m_mcServerPath));
+        QFile file(getMinecraftServerPropertiesPath(mcServerPath));
         if(!file.open(QIODevice::ReadOnly))
         {
             return;
@@ -354,15 +412,15 @@ void MainWindow::on_actionExit_triggered()
     if(ui->forceDisconnectButton->isEnabled()){
         forceDisconnect();
     }
-    if(m_pServerProcess)
+    if(m_pController)
     {
-        if(m_pServerProcess->state() == QProcess::Running)
+        if(m_pController->state() == QProcess::Running)
         {
             on_actionStop_triggered();
-            m_pServerProcess->waitForFinished();
+            m_pController->waitForFinished();
         }
 
-        if(m_pServerProcess->state() == QProcess::NotRunning)
+        if(m_pController->state() == QProcess::NotRunning)
         {
             closeApplication();
         }
@@ -379,29 +437,32 @@ void MainWindow::on_actionSettings_triggered()
 
     if(settingsDlg)
     {
-        settingsDlg->setUseCustomJavaPath(m_useCustomJavaPath);
-        settingsDlg->setCustomJavaPath(m_customJavaPath);
-        settingsDlg->setMinecraftServerPath(m_mcServerPath);
-        settingsDlg->setXms(m_xms);
-        settingsDlg->setXmx(m_xmx);
-        settingsDlg->setAdditionalParameters(m_additionalParameters);
+        ServerSettings& settings = m_pController->settings();
+
+        settingsDlg->setUseCustomJavaPath(settings.useCustomJavaPath);
+        settingsDlg->setCustomJavaPath(settings.customJavaPath);
+        settingsDlg->setMinecraftServerPath(settings.mcServerPath);
+        settingsDlg->setXms(settings.xms);
+        settingsDlg->setXmx(settings.xmx);
+        settingsDlg->setAdditionalParameters(settings.additionalParameters);
 
         settingsDlg->initialize();
 
         if(settingsDlg->exec() == QDialog::Accepted)
         {
-            updateWatchedFileSystemPath( getMinecraftServerPropertiesPath(m_mcServerPath),
+            updateWatchedFileSystemPath( getMinecraftServerPropertiesPath(settings.mcServerPath),
                                          getMinecraftServerPropertiesPath(settingsDlg->getMinecraftServerPath()));
 
-            updateWatchedDirSystemPath( getMinecraftServerWorkingDirectoryPath(m_mcServerPath),
+            updateWatchedDirSystemPath( getMinecraftServerWorkingDirectoryPath(settings.mcServerPath),
                                         getMinecraftServerWorkingDirectoryPath(settingsDlg->getMinecraftServerPath()));
 
-            m_mcServerPath = settingsDlg->getMinecraftServerPath();
-            m_customJavaPath = settingsDlg->getCustomJavaPath();
-            m_useCustomJavaPath = settingsDlg->useCustomJavaPath();
-            m_xms = settingsDlg->getXms();
-            m_xmx = settingsDlg->getXmx();
-            m_additionalParameters = settingsDlg->getAdditionalParameters();
+            settings.mcServerPath = settingsDlg->getMinecraftServerPath();
+            settings.customJavaPath = settingsDlg->getCustomJavaPath();
+            settings.useCustomJavaPath = settingsDlg->useCustomJavaPath();
+            settings.xms = settingsDlg->getXms();
+            settings.xmx = settingsDlg->getXmx();
+            settings.additionalParameters = settingsDlg->getAdditionalParameters();
+            m_pController->updateLogsPath();
 
             loadServerProperties();
         }
@@ -413,30 +474,12 @@ void MainWindow::on_actionSettings_triggered()
 
 QString MainWindow::getMinecraftServerPropertiesPath(const QString& mcServerPath)
 {
-    QString mcServerPropertiesPath = "";
-
-    if(!mcServerPath.isEmpty())
-    {
-        QFileInfo mcServerFileInfo = QFileInfo(mcServerPath);
-        QString workingDir = mcServerFileInfo.absolutePath();
-
-        mcServerPropertiesPath = workingDir + QString("/server.properties");
-    }
-
-    return mcServerPropertiesPath;
+    return ServerSettings::propertiesPath(mcServerPath);
 }
 
 QString MainWindow::getMinecraftServerWorkingDirectoryPath(const QString& mcServerPath)
 {
-    QString mcServerWorkingDirectoryPath = "";
-
-    if(!mcServerPath.isEmpty())
-    {
-        QFileInfo mcServerFileInfo = QFileInfo(mcServerPath);
-        mcServerWorkingDirectoryPath = mcServerFileInfo.absolutePath();
-    }
-
-    return mcServerWorkingDirectoryPath;
+    return ServerSettings::workingDirectory(mcServerPath);
 }
 
 void MainWindow::updateWatchedFileSystemPath(const QString& oldPath, const QString& newPath)
@@ -488,92 +531,17 @@ void MainWindow::updateWatchedDirSystemPath(const QString &oldPath, const QStrin
 
 void MainWindow::on_actionStart_triggered()
 {
-    if(m_mcServerPath.isEmpty())
+    if(!m_pController->start())
     {
         QMessageBox::information(this, tr("Qt Minecraft Server"),
                                  tr("No Minecraft Server File available!\nPlease select a Minecraft Server File at Qt Minecraft Server Settings."));
 
         on_actionSettings_triggered();
-
-        return;
-    }
-
-    if(m_pServerProcess)
-    {
-        QFileInfo mcServerFileInfo = QFileInfo(m_mcServerPath);
-        QString workingDir = mcServerFileInfo.absolutePath();
-        QString mcServerFile = mcServerFileInfo.fileName();
-        QStringList mcServerFileTypeList = mcServerFile.split('.');
-        QString mcServerFileType =  mcServerFileTypeList.rbegin()[0];
-
-        m_pServerProcess->setWorkingDirectory(workingDir);
-
-        QStringList arguments;
-        if(mcServerFileType=="bat"){
-            arguments.append("/c");
-            arguments.append(mcServerFile);
-            ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; Starting Java VM (bat) in Working Directory: %1...")
-                                                    .arg(QDir::toNativeSeparators(workingDir))));
-            ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; cmd.exe %1").arg(arguments.join(" "))));
-            m_pServerProcess->start("cmd.exe",arguments, QIODevice::ReadWrite | QIODevice::Unbuffered);
-            if(!m_pServerProcess->waitForStarted())
-            {
-                ui->serverLogTextEdit->append(htmlRed(tr("&gt;&gt; Unable to start bat.")));
-            }
-        }else{
-
-
-            if(m_xms > 0)
-            {
-                arguments.append(QString("-Xms%1M").arg(QString::number(m_xms)));
-                on_actionSaveServerProperties_triggered();
-
-            }
-
-            if(m_xmx > 0)
-            {
-                arguments.append(QString("-Xmx%1M").arg(QString::number(m_xmx)));
-            }
-
-            arguments.append("-jar");
-            arguments.append(mcServerFile);
-            arguments.append("nogui");
-
-            if(!m_additionalParameters.isEmpty())
-            {
-                arguments.append(m_additionalParameters);
-            }
-
-            on_actionSaveServerProperties_triggered();
-
-            ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; Starting Java VM in Working Directory: %1...")
-                                                   .arg(QDir::toNativeSeparators(workingDir))));
-
-            if(m_useCustomJavaPath)
-            {
-                ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; %1 %2").arg(QDir::toNativeSeparators(m_customJavaPath))
-                                                       .arg(arguments.join(" "))));
-
-                m_pServerProcess->start(m_customJavaPath, arguments, QIODevice::ReadWrite | QIODevice::Unbuffered);
-            }
-            else
-            {
-                ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; java %1").arg(arguments.join(" "))));
-                m_pServerProcess->start("java", arguments, QIODevice::ReadWrite | QIODevice::Unbuffered);
-            }
-
-            if(!m_pServerProcess->waitForStarted())
-            {
-                ui->serverLogTextEdit->append(htmlRed(tr("&gt;&gt; Unable to start Java VM.")));
-            }
-        }
     }
 }
 
 void MainWindow::onStart()
 {
-    ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; Starting Minecraft Server...")));
-
     ui->actionStart->setEnabled(false);
     ui->actionStop->setEnabled(true);
     ui->actionSettings->setEnabled(false);
@@ -586,18 +554,9 @@ void MainWindow::onStart()
 
 void MainWindow::onFinish(int exitCode, QProcess::ExitStatus exitStatus)
 {
-    if((exitStatus == QProcess::NormalExit) && (exitCode ==  0))
-    {
-        ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; Minecraft Server stopped normally with exit code: %1").arg(exitCode)));
-    }
-    else if((exitStatus == QProcess::NormalExit) && (exitCode ==  1))
-    {
-        ui->serverLogTextEdit->append(htmlRed(tr("&gt;&gt; Minecraft Server killed and exited with exit code: %1").arg(exitCode)));
-    }
-    else if(exitStatus == QProcess::CrashExit)
-    {
-        ui->serverLogTextEdit->append(htmlRed(tr("&gt;&gt; Minecraft Server crashed!")));
-    }
+    // the exit is reported on the console by the controller
+    Q_UNUSED(exitCode);
+    Q_UNUSED(exitStatus);
 
     ui->actionStart->setEnabled(true);
     ui->actionStop->setEnabled(false);
@@ -609,41 +568,13 @@ void MainWindow::onFinish(int exitCode, QProcess::ExitStatus exitStatus)
     statusLedLabel->setPixmap(QPixmap("://images/led-red.png"));
 }
 
-void MainWindow::onStandardOutput()
-{
-    QByteArray baOutput = m_pServerProcess->readAllStandardOutput();
-    QString str;
-
-    if (!baOutput.isEmpty())
-    {
-        str = QString::fromUtf8(baOutput).trimmed();
-
-        if(!str.isEmpty())
-            ui->serverLogTextEdit->append(str);
-    }
-}
-
-void MainWindow::onStandardError()
-{
-    QByteArray baError = m_pServerProcess->readAllStandardError();
-    QString str;
-
-    if (!baError.isEmpty())
-    {
-        str = QString(baError).trimmed();
-
-        if(!str.isEmpty())
-        {
-            ui->serverLogTextEdit->append(str);
-        }
-    }
-}
-
 void MainWindow::onWatchedFileChanged(const QString &path)
 {
-    if(!m_mcServerPath.isEmpty())
+    QString mcServerPath = m_pController->settings().mcServerPath;
+
+    if(!mcServerPath.isEmpty())
     {
-        if(path == getMinecraftServerPropertiesPath(m_mcServerPath))
+        if(path == getMinecraftServerPropertiesPath(mcServerPath))
         {
             loadServerProperties();
         }
@@ -652,11 +583,13 @@ void MainWindow::onWatchedFileChanged(const QString &path)
 
 void MainWindow::onWatchedDirChanged(const QString &path)
 {
-    if(!m_mcServerPath.isEmpty())
+    QString mcServerPath = m_pController->settings().mcServerPath;
+
+    if(!mcServerPath.isEmpty())
     {
-        if(path == getMinecraftServerWorkingDirectoryPath(m_mcServerPath))
+        if(path == getMinecraftServerWorkingDirectoryPath(mcServerPath))
         {
-            QString mcServerPropertiesPath = getMinecraftServerPropertiesPath(m_mcServerPath);
+            QString mcServerPropertiesPath = getMinecraftServerPropertiesPath(mcServerPath);
 
             if(QFile::exists(mcServerPropertiesPath))
             {
@@ -668,21 +601,7 @@ void MainWindow::onWatchedDirChanged(const QString &path)
 
 void MainWindow::on_actionStop_triggered()
 {
-    if(m_pServerProcess)
-    {
-        if(m_pServerProcess->state() == QProcess::Running)
-        {
-            ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; Stopping Minecraft Server...")));
-
-            if(m_pServerProcess->isWritable())
-            {
-                QByteArray command = (QString("stop") + QString("\n")).toLatin1();
-
-                m_pServerProcess->write(command);
-                m_pServerProcess->waitForBytesWritten();
-            }
-        }
-    }
+    m_pController->stop();
 }
 
 void MainWindow::on_sendCommandButton_clicked()
@@ -690,27 +609,11 @@ void MainWindow::on_sendCommandButton_clicked()
     if(ui->serverCommandLineEdit->text().isEmpty())
         return;
 
-    if(m_pServerProcess)
+    if(m_pController->state() == QProcess::Running)
     {
-        if(m_pServerProcess->state() == QProcess::Running)
-        {
-            if(m_pServerProcess->isWritable())
-            {
-                ui->serverLogTextEdit->append(htmlGreen(QString("&lt;&lt; ") + ui->serverCommandLineEdit->text()));
+        m_pController->sendCommands(QStringList() << ui->serverCommandLineEdit->text());
 
-                if(ui->serverCommandLineEdit->text().trimmed() == "stop")
-                {
-                    ui->serverLogTextEdit->append(htmlBlue(tr("&gt;&gt; Stopping Minecraft Server...")));
-                }
-
-                QByteArray command = (ui->serverCommandLineEdit->text() + QString("\n")).toLatin1();
-
-                m_pServerProcess->write(command);
-                m_pServerProcess->waitForBytesWritten();
-
-                ui->serverCommandLineEdit->clear();
-            }
-        }
+        ui->serverCommandLineEdit->clear();
     }
 }
 
@@ -721,33 +624,204 @@ void MainWindow::on_serverCommandLineEdit_returnPressed()
 
 void MainWindow::on_actionClear_triggered()
 {
-    ui->serverLogTextEdit->clear();
+    m_pConsoleModel->clear();
+}
+
+void MainWindow::copyConsoleSelection()
+{
+    QModelIndexList selection = ui->serverLogView->selectionModel()->selectedRows();
+    if(selection.isEmpty())
+        return;
+
+    std::sort(selection.begin(), selection.end());
+
+    QStringList lines;
+    foreach(const QModelIndex& index, selection)
+    {
+        lines.append(index.data(Qt::DisplayRole).toString());
+    }
+
+    QApplication::clipboard()->setText(lines.join("\n"));
+}
+
+void MainWindow::on_actionFind_triggered()
+{
+    ui->mainTabWidget->setCurrentWidget(ui->tabConsole);
+    ui->searchLineEdit->setFocus();
+    ui->searchLineEdit->selectAll();
+}
+
+void MainWindow::on_searchLineEdit_returnPressed()
+{
+    findInConsole(false);
+}
+
+void MainWindow::on_searchNextButton_clicked()
+{
+    findInConsole(false);
+}
+
+void MainWindow::on_searchPreviousButton_clicked()
+{
+    findInConsole(true);
+}
+
+void MainWindow::findInConsole(bool backwards)
+{
+    QString pattern = ui->searchLineEdit->text();
+    bool regex = ui->searchRegexCheckBox->isChecked();
+
+    if(pattern.isEmpty())
+    {
+        m_searchHits.clear();
+        ui->searchResultLabel->clear();
+        return;
+    }
+
+    QString timing;
+
+    if(pattern != m_searchPattern || regex != m_searchRegex || m_searchHits.isEmpty())
+    {
+        QElapsedTimer elapsed;
+        elapsed.start();
+
+        m_searchHits = m_pConsoleModel->search(pattern, regex);
+        m_searchPattern = pattern;
+        m_searchRegex = regex;
+
+        // a new search starts at the most recent hit
+        m_searchHitIndex = m_searchHits.size() - 1;
+        timing = tr(" (%1 ms)").arg(elapsed.elapsed());
+    }
+    else
+    {
+        // hits that scrolled out of the buffer are gone
+        quint64 first = m_pConsoleModel->buffer().firstSequence();
+        while(!m_searchHits.isEmpty() && m_searchHits.first() < first)
+        {
+            m_searchHits.removeFirst();
+            m_searchHitIndex--;
+        }
+        m_searchHitIndex = qMax(m_searchHitIndex, 0);
+
+        if(!m_searchHits.isEmpty())
+        {
+            m_searchHitIndex += backwards ? -1 : 1;
+            m_searchHitIndex = (m_searchHitIndex + m_searchHits.size()) % m_searchHits.size();
+        }
+    }
+
+    if(m_searchHits.isEmpty())
+    {
+        ui->searchResultLabel->setText(tr("No matches") + timing);
+        return;
+    }
+
+    int row = m_pConsoleModel->rowForSequence(m_searchHits.at(m_searchHitIndex));
+    if(row >= 0)
+    {
+        QModelIndex index = m_pConsoleModel->index(row);
+        ui->serverLogView->setCurrentIndex(index);
+        ui->serverLogView->scrollTo(index, QAbstractItemView::PositionAtCenter);
+    }
+
+    ui->searchResultLabel->setText(tr("%1 of %2").arg(m_searchHitIndex + 1).arg(m_searchHits.size()) + timing);
 }
 
 void MainWindow::on_actionExport_triggered()
 {
+    if(m_pExportThread)
+    {
+        m_pExportProgress->show();
+        return;
+    }
+
+    ExportDialog exportDialog(this);
+    if(exportDialog.exec() != QDialog::Accepted)
+        return;
+
     QString fileName = QFileDialog::getSaveFileName(this, tr("Export Console Log"),
                                "mcserverlog.txt",
                                tr("Text Files (*.txt)"));
-    if(!fileName.isEmpty())
+    if(fileName.isEmpty())
+        return;
+
+    m_pExporter = new ConsoleExporter(fileName, exportDialog.filter());
+
+    // the journal holds more than the scrollback, export from it when possible
+    QStringList segments;
+    if(!m_pController->journalPath().isEmpty())
     {
-        QFile outfile;
-        outfile.setFileName(fileName);
+        m_pController->flushJournal();
+        segments = ConsoleJournal::segmentFiles(m_pController->journalPath());
+    }
 
-        if(outfile.open(QIODevice::WriteOnly | QIODevice::Text))
-        {
-            QTextStream out(&outfile);
-            out << ui->serverLogTextEdit->toPlainText() << endl;
-            outfile.close();
-        }
+    if(segments.isEmpty())
+    {
+        m_pController->drainConsole();
+        m_pExporter->setLines(m_pConsoleModel->buffer());
     }
+    else
+    {
+        m_pExporter->setJournal(segments);
+    }
+
+    m_pExportProgress = new QProgressDialog(tr("Exporting console log..."), tr("Cancel"), 0, 100, this);
+    m_pExportProgress->setWindowTitle(tr("Export Console Log"));
+    m_pExportProgress->setMinimumDuration(500);
+    m_pExportProgress->setValue(0);
+
+    m_pExportThread = new QThread(this);
+    m_pExporter->moveToThread(m_pExportThread);
+
+    // the exporter is busy in run(), so cancel() has to be called directly
+    connect( m_pExportProgress, SIGNAL(canceled()), m_pExporter, SLOT(cancel()), Qt::DirectConnection );
+    connect( m_pExportThread, SIGNAL(started()), m_pExporter, SLOT(run()) );
+    connect( m_pExportThread, SIGNAL(finished()), m_pExporter, SLOT(deleteLater()) );
+    connect( m_pExporter, SIGNAL(progress(int)), SLOT(onExportProgress(int)) );
+    connect( m_pExporter, SIGNAL(finished(int,qint64)), SLOT(onExportFinished(int,qint64)) );
+
+    m_pExportThread->start(QThread::LowPriority);
+}
+
+void MainWindow::onExportProgress(int percent)
+{
+    if(m_pExportProgress && !m_pExportProgress->wasCanceled())
+        m_pExportProgress->setValue(percent);
+}
+
+void MainWindow::onExportFinished(int result, qint64 lines)
+{
+    if(result == ConsoleExporter::Succeeded)
+    {
+        appendConsoleMessage(tr(">> Exported %1 lines").arg(lines), ConsoleStyle::Notice);
+    }
+    else if(result == ConsoleExporter::Canceled)
+    {
+        appendConsoleMessage(tr(">> Export canceled"), ConsoleStyle::Notice);
+    }
+    else
+    {
+        appendConsoleMessage(tr(">> Export failed: %1").arg(m_pExporter->errorString()), ConsoleStyle::Failure);
+    }
+
+    m_pExportThread->quit();
+    m_pExportThread->wait();
+    m_pExportThread->deleteLater();
+    m_pExportThread = 0;
+    m_pExporter = 0;
+
+    m_pExportProgress->deleteLater();
+    m_pExportProgress = 0;
 }
 
 void MainWindow::on_actionSaveServerProperties_triggered()
 {
-    if(!m_mcServerPath.isEmpty())
+    QString mcServerPath = m_pController->settings().mcServerPath;
+
+    if(!mcServerPath.isEmpty())
     {
-        QFileInfo mcServerFileInfo = QFileInfo(m_mcServerPath);
+        QFileInfo mcServerFileInfo = QFileInfo(mcServerPath);
         QString workingDir = mcServerFileInfo.absolutePath();
         qDebug()<<workingDir;
         QFile outfile;
@@ -765,7 +839,7 @@ void MainWindow::on_actionSaveServerProperties_triggered()
 
 void MainWindow::on_actionRefreshServerProperties_triggered()
 {
-    QString mcServerPropertiesPath = getMinecraftServerPropertiesPath(m_mcServerPath);
+    QString mcServerPropertiesPath = getMinecraftServerPropertiesPath(m_pController->settings().mcServerPath);
     updateWatchedFileSystemPath(mcServerPropertiesPath, mcServerPropertiesPath);
 
     loadServerProperties();
@@ -777,30 +851,6 @@ void MainWindow::on_serverCommandLineEdit_textEdited(const QString &text)
 }
 
 //===2018new===
-void MainWindow::keyAlgorithm(){
-    QString dateNow = QDateTime::currentDateTime().toString("yyyy/MM/dd-HH:mm");
-    QByteArray dateBA = dateNow.toLatin1();
-    connectKeyBA = QCryptographicHash::hash(dateBA,QCryptographicHash::Sha3_512);
-    QString keyS = QString::fromLatin1(connectKeyBA.data());
-    //qDebug()<<"dateBA:"<<dateBA;
-    //qDebug()<<"connectKeyBA:"<<connectKeyBA;
-    //qDebug()<<"keyS:"<<keyS.toLatin1();
-}
-QString MainWindow::getMinecraftLogsPath(const QString& mcServerPath)
-{
-    QString mcServerLogsPath = "";
-
-    if(!mcServerPath.isEmpty())
-    {
-        QFileInfo mcServerFileInfo = QFileInfo(mcServerPath);
-        QString workingDir = mcServerFileInfo.absolutePath();
-
-        mcServerLogsPath = workingDir + QString("/logs/latest.log");
-    }
-
-    return mcServerLogsPath;
-}
-
 void MainWindow::writeToFile(QString FileNameT, QString strT){
     QFile FileT(FileNameT);
     //開啟檔案
@@ -815,263 +865,72 @@ void MainWindow::writeToFile(QString FileNameT, QString strT){
 }
 //---SLOT---
 void MainWindow::serverStart(){
-    ui->forceDisconnectButton->setText("Stop Listening");
-    connect(&Server,SIGNAL(newConnection()),this,SLOT(acceptConnection()));
-    //TODO ServerPort change to lineEdit
-    ServerPort  =  7777;
-    Server.listen(QHostAddress::AnyIPv4,ServerPort);
+    //port is Settings/RemotePort, 7777 unless changed
+    m_pController->listenRemote();
     QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
     remoteLog.append(htmlGreen("========RemoteServerStarted!!========"));
     ui->connectionLogText->append(remoteLog);
-    remoteStatusLabel->setText(tr("Remote Server: Listening"));
-    remoteStatusLedLabel->setPixmap(QPixmap("://images/led-orange.png"));
+    onRemoteSessionsChanged(0, 0);
     refreshKey_slot();
 }
 
-void MainWindow::acceptConnection(){//accept&check verification
-    qDebug()<<"[Pit]new connection";
-    firstConnect = true;
-    firstConnectTimer = new QTimer;
-    firstConnectTimer->start(3*1000);
-    connect(firstConnectTimer,SIGNAL(timeout()),this,SLOT(timerTimeout()));
-//    ui->RestartServerButton->setEnabled(true);
-//    ui->exportLogButton->setEnabled(true);
-//    ui->cleanLogButton->setEnabled(true);
-//    ui->forceDisconnectButton->setEnabled(true);
-    ui->forceDisconnectButton->setText("Force Disconnect");
-    remoteStatusLabel->setText(tr("Remote Server: Connected!"));
-    remoteStatusLedLabel->setPixmap(QPixmap("://images/led-green.png"));
-    ServerConnection = Server.nextPendingConnection();
-    Server.close();//關閉其他客戶端連線
-    //以上是從TCP server物件取得已接受連線
+void MainWindow::onRemoteLog(const QString &text, int kind){
     QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
-    remoteLog.append(htmlBlue("========RemoteServerConnect!!========"));
-    ui->connectionLogText->append(remoteLog);
-    connect(ServerConnection,SIGNAL(readyRead()),this,SLOT(readMessage()));
-    connect(ServerConnection,SIGNAL(disconnected()),this,SLOT(serverDisconnected()));
-    ClientIPaddress = ServerConnection->peerAddress().toString();
-    ClientPort = ServerConnection->peerPort();
-    //---
-    remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
-    remoteLog.append(htmlBlue("Remote Client Connect from:"+ClientIPaddress+
-                     ":"+QString::number(ClientPort)));
+    switch(kind){
+    case RemoteServer::LogInfo:    remoteLog.append(htmlBlue(text)); break;
+    case RemoteServer::LogSuccess: remoteLog.append(htmlGreen(text)); break;
+    case RemoteServer::LogNotice:  remoteLog.append(htmlPurple(text)); break;
+    case RemoteServer::LogError:   remoteLog.append(htmlRed(text)); break;
+    default:                       remoteLog.append(text.toHtmlEscaped()); break;
+    }
     ui->connectionLogText->append(remoteLog);
-    //---
 }
 
-void MainWindow::readMessage(){
-    qDebug()<<"[PIT]readMessage";
-    //---read---
-    QByteArray ServerRead = ServerConnection->read(ServerConnection->bytesAvailable());
-    QString strIN = QString::fromLatin1(ServerRead,ServerRead.size());
-    //qDebug()<<"strINsize"<<strIN.size()<<"readsize"<<ServerRead.size();
-    //---analysis---
-    QStringList strList = strIN.split('|');
-    QString strType = strList[0];
-    QString strCommand = strList[1];
-//    qDebug()<<"listsize"<<strList.size();
-//    qDebug()<<"strIN"<<strIN;
-//    qDebug()<<"strINBA"<<strCommand.toLatin1();
-//    qDebug()<<"self"<<connectKeyBA;
-    //------
-    QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
-    if(strList.size()!=2){
-        if(strList.size() < 2){
-            qDebug()<<"strList.size amount to small";
-            remoteLog.append(htmlRed("\"error format\""));
-            qDebug()<<remoteLog;
-            ui->connectionLogText->append(remoteLog);
-            return;
-        }else if(strList.size() > 2){
-            qDebug()<<"strList.size amount to many";
-            for(int i=2;i<strList.size();i++){
-                strCommand.append('|');
-                strCommand.append(strList[i]);
-            }
-        }
-    }
-    if(!firstConnect && strType == "key"){
-        qDebug()<<"[PIT]not first time connect";
-    }
-    if(firstConnect){
-        qDebug()<<"[PIT]first time connect";
-        disconnect(firstConnectTimer,SIGNAL(timeout()),this,SLOT(timerTimeout()));
-        firstConnectTimer->destroyed();
-        firstConnect =false;
-        if(strType == "key"){
-            if(connectKeyBA == strCommand.toLatin1()){
-                remoteLog.append(htmlBlue("========Verification Succesful========"));
-                ServerConnection->write("remote|success");
-                ServerConnection->waitForBytesWritten();
-            }else{
-                remoteLog.append(htmlPurple("Reason : Verification fail(wrong key)"));
-                ServerConnection->write("remote|Verification fail|wrong key");
-                ServerConnection->waitForBytesWritten();
-                restartServer();
-                //ServerConnection->disconnectFromHost();
-            }
-        }else{
-            remoteLog.append(htmlPurple("Reason : Verification fail(didn't found any key)"));
-            ServerConnection->write("remote|Verification fail|didn't found any key");
-            ServerConnection->waitForBytesWritten();
-            restartServer();
-            //ServerConnection->disconnectFromHost();
-        }
-    }else if(strType == "button"){
-        if(strCommand == "start"){
-            if(ui->actionStart->isEnabled()) on_actionStart_triggered();
-            remoteLog.append("PushButton\"start\"");
-        }else if(strCommand == "stop"){
-            if(ui->actionStop->isEnabled()) {
-                on_actionStop_triggered();
-                ui->actionStop->setEnabled(false);
-            }
-            remoteLog.append("PushButton\"stop\"");
-        }
-    }else if(strType == "command"){
-        ui->serverCommandLineEdit->text().toLatin1();
-        if(strCommand=="texttest"){
-            return;
-        }
-        if(statusLabel->text()==QString::fromLatin1("Minecraft Server: Stopped")){
-            qDebug()<<"sendCommandButtonN";
-            ServerConnection->write("reason|Send Command Error Occur!!Reason : Server isn't running.");
-            ServerConnection->waitForBytesWritten();
-        }
-        else{
-            qDebug()<<"sendCommandButtonY";
-            ui->serverCommandLineEdit->setText(QString::fromUtf8(strCommand.toLatin1()));
-            on_sendCommandButton_clicked();
-        }
-        remoteLog.append("ReceiveCommand");
-        remoteLog.append("\""+strCommand+"\"");
-    }else if(strType == "file"){
-        prepareSend();
-        remoteLog.append("PushButton\"get logs\" size:"+QString::number(totalBytes/1024.0)+"KB");
-        ServerConnection->waitForBytesWritten();
-    }else if(strType == "mcServerStatus"){
-        ServerConnection->write("mcServerStatus|"+QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ").toLatin1()+
-                                statusLabel->text().toLatin1());
-        remoteLog.append("PushButton\"get mcServerStatus\"");
-        ServerConnection->waitForBytesWritten();
-    }else if(strType == "mcServerLogs"){
-        if(strCommand==""){
-            if(!ui->serverLogTextEdit->document()->isEmpty()){
-                MCServerLogsTemp = ui->serverLogTextEdit->document()->toHtml();
-                MCServerLogsSize = MCServerLogsTemp.size();
-                QString strSend = "mcServerLogs|"+QString::number(MCServerLogsSize);
-                ServerConnection->write(strSend.toLatin1());
-                ServerConnection->waitForBytesWritten();
-            }else{
-                ServerConnection->write("reason|mcServerLogs:Didn't Found Any Logs.");
-                ServerConnection->waitForBytesWritten();
-            }
-        }else if(strCommand=="start"){
-            qDebug()<<"[PIT]MCServerLogs:Start";
-
-//            QDataStream sendOut(&outBlock,QIODevice::WriteOnly);
-//            sendOut.setVersion(QDataStream::Qt_4_6);//設定QT資料格式版本號
-//            sendOut<<MCServerLogsTemp;
-//            outBlock.resize(0);//清空outBlock
-
-
-            QTextStream  textSendOut(&outBlockText,QIODevice::WriteOnly);
-            textSendOut<<MCServerLogsTemp;
-            qDebug()<<"write bits"<<ServerConnection->write(outBlockText.toLatin1());
-            ServerConnection->waitForBytesWritten();
-            qDebug()<<"totalBits"<<MCServerLogsSize<<"checkBits"<<outBlockText.size();
-            outBlockText.resize(0);
-            MCServerLogsTemp = "";
-            MCServerLogsSize = 0;
-
-            //ServerConnection->write(MCServerLogsTemp.toLatin1());
-            //ServerConnection->waitForBytesWritten();
-        }else if(strCommand=="finished"){
-            qDebug()<<"[PIT]MCServerLogs:finished";
-            remoteLog.append(htmlGreen("successfully send logs"));
-            ui->connectionLogText->append(remoteLog);
-        }
-        return;
-//        if(!ui->serverLogTextEdit->document()->isEmpty()){
-//            ui->serverLogTextEdit->moveCursor( QTextCursor::End, QTextCursor::MoveAnchor );
-//            ui->serverLogTextEdit->moveCursor( QTextCursor::StartOfLine, QTextCursor::MoveAnchor );
-//            ui->serverLogTextEdit->moveCursor( QTextCursor::EndOfLine, QTextCursor::KeepAnchor );
-//            QString lastLineStr = ui->serverLogTextEdit->textCursor().selectedText();
-//            ui->serverLogTextEdit->moveCursor( QTextCursor::End, QTextCursor::MoveAnchor );
-//            ui->serverLogTextEdit->setTextColor(QColor(0,0,0));
-//            ServerConnection->write("mcServerLogs|"+htmlBlue(lastLineStr).toLatin1());
-//            ServerConnection->waitForBytesWritten();
-//        }else{
-
-//        }
-
-    }else if(strType == "mcLogsUpdate"){
-        if(MCServerLogsSize){
-            qint64 MCServerLogsSizeNow = ui->serverLogTextEdit->document()->toHtml().size();
-            if(MCServerLogsSizeNow - MCServerLogsSize>0){
-                MCServerLogs = ui->serverLogTextEdit->document()->toHtml();
-                QString MCServerLogsDiff = MCServerLogs;
-                MCServerLogsDiff.remove(0,MCServerLogsSize-1);
-                MCServerLogsSize = MCServerLogsSizeNow;
-                ServerConnection->write("mcLogsUpdate|"+MCServerLogsDiff.toLatin1());
-                ServerConnection->waitForBytesWritten();
-                return;
-            }
-        }
+void MainWindow::onRemoteSessionsChanged(int sessions, int authenticated){
+    m_remoteSessions = sessions;
+    //the button is off while not listening
+    if(!ui->forceDisconnectButton->isEnabled()) return;
+    if(sessions > 0){
+        ui->forceDisconnectButton->setText("Force Disconnect");
+        remoteStatusLabel->setText(tr("Remote Server: %1 connected, %2 verified").arg(sessions).arg(authenticated));
+        remoteStatusLedLabel->setPixmap(QPixmap("://images/led-green.png"));
     }else{
-        remoteLog.append(htmlRed("\"error format\"->")+htmlPurple(strIN));
+        ui->forceDisconnectButton->setText("Stop Listening");
+        remoteStatusLabel->setText(tr("Remote Server: Listening"));
+        remoteStatusLedLabel->setPixmap(QPixmap("://images/led-orange.png"));
     }
-    //qDebug()<<remoteLog;
-    ui->connectionLogText->append(remoteLog);
-    ui->connectionLogText->setTextColor(QColor(0,0,0));
-}
-void MainWindow::serverDisconnected(){
-    qDebug()<<"[PIT]serverDisconnected";
-    ui->forceDisconnectButton->setText("Stop Listening");
-    disconnect(ServerConnection,SIGNAL(readyRead()),this,SLOT(readMessage()));
-    disconnect(ServerConnection,SIGNAL(disconnected()),this,SLOT(serverDisconnected()));
-    QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
-    remoteLog.append(htmlRed("========RemoteServerDisconnect!!========"));
-    ui->connectionLogText->append(remoteLog);
-    remoteStatusLabel->setText(tr("Remote Server: Listening"));
-    remoteStatusLedLabel->setPixmap(QPixmap("://images/led-orange.png"));
-    Server.listen(QHostAddress::AnyIPv4,ServerPort);
 }
 
 void MainWindow::generateKey(){
-    //qDebug()<<"connectKeyBA:"<<connectKeyBA;
+    QString key = QString::fromLatin1(m_pController->key());
     ui->CopyButton->setEnabled(true);
     ui->refreshKeyButton->setEnabled(true);
-    ui->keyLineEdit->setText(QString::fromLatin1(connectKeyBA));
+    ui->keyLineEdit->setText(key);
     QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
-    remoteLog.append(htmlColor("key is:"+htmlColor(QString::fromLatin1(connectKeyBA),"orange"),"black"));
+    remoteLog.append(htmlColor("key is:"+htmlColor(key,"orange"),"black"));
     ui->connectionLogText->append(remoteLog);
 }
 
 void MainWindow::refreshKey_slot(){
-    keyAlgorithm();
+    m_pController->refreshKey();
     generateKey();
 }
 
 void MainWindow::forceDisconnect(){
-    remoteStatusLabel->setText(tr("Remote Server: Disconnected"));
-    remoteStatusLedLabel->setPixmap(QPixmap("://images/led-red.png"));
     QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
-    if(ui->forceDisconnectButton->text()=="Force Disconnect"){
-        disconnect(firstConnectTimer,SIGNAL(timeout()),this,SLOT(timerTimeout()));
-        ServerConnection->disconnectFromHost();
+    if(m_remoteSessions > 0){
         remoteLog.append(htmlRed("========RemoteServerForceDisconnect!!========"));
     }else{
-
         remoteLog.append(htmlRed("========RemoteServerStopListening!!========"));
     }
+    m_pController->closeRemote();
+    remoteStatusLabel->setText(tr("Remote Server: Disconnected"));
+    remoteStatusLedLabel->setPixmap(QPixmap("://images/led-red.png"));
     ui->connectionLogText->append(remoteLog);
     ui->RestartServerButton->setEnabled(true);
     ui->forceDisconnectButton->setEnabled(false);
     ui->RestartServerButton->setText("Start Server");
-    Server.close();
 }
-
 void MainWindow::restartServer(){
     ui->RestartServerButton->setEnabled(false);
     QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
@@ -1083,11 +942,10 @@ void MainWindow::restartServer(){
         ui->RestartServerButton->setText("Restart Server");
         remoteLog.append(htmlGreen("========RemoteServerstart!!========"));
     }
-    Server.listen(QHostAddress::AnyIPv4,ServerPort);
+    m_pController->listenRemote();
     ui->forceDisconnectButton->setEnabled(true);
     ui->connectionLogText->append(remoteLog);
-    remoteStatusLabel->setText(tr("Remote Server: Listening"));
-    remoteStatusLedLabel->setPixmap(QPixmap("://images/led-orange.png"));
+    onRemoteSessionsChanged(0, 0);
     refreshKey_slot();
     ui->RestartServerButton->setEnabled(true);
 }
@@ -1108,60 +966,6 @@ void MainWindow::ExportRemoteServerLog(){
     ui->connectionLogText->append(remoteLog);
 }
 
-void MainWindow::timerTimeout(){
-    disconnect(firstConnectTimer,SIGNAL(timeout()),this,SLOT(timerTimeout()));
-    ServerConnection->write("remote|Verification fail|Timeout");
-    ServerConnection->waitForBytesWritten();
-    //serverDisconnected();
-    //forceDisconnect();
-    restartServer();
-    QString remoteLog = QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ");
-    remoteLog.append(htmlPurple("Reason : Verification fail(Timeout)"));
-    ui->connectionLogText->append(remoteLog);
-}
-
-void MainWindow::prepareSend(){
-    qDebug()<<"[PIT]prepareSend";
-    connect(ServerConnection,SIGNAL(bytesWritten(qint64)),this,SLOT(updateClientProgress(qint64)));
-    QString logsPath = getMinecraftLogsPath(m_mcServerPath);
-    qDebug()<<"logsPath"<<logsPath;
-    LF = new QFile(logsPath);
-    if(!LF->open(QFile::ReadOnly)){
-        QMessageBox::warning(this,QStringLiteral("應用程式"),
-                             QStringLiteral("無法讀取 %1\n%2.").
-                             arg(logsPath,LF->errorString()));
-        return;
-    }
-    totalBytes = LF->size();//傳送檔案大小
-
-    QDataStream sendOut(&outBlock,QIODevice::WriteOnly);
-    sendOut.setVersion(QDataStream::Qt_4_6);//設定QT資料格式版本號
-    QString CF = logsPath.right(logsPath.size()-//currentfile
-                                logsPath.lastIndexOf("/")-1);
-    sendOut<<qint64(0)<<qint64(0)<<CF;
-    totalBytes +=outBlock.size();
-    sendOut.device()->seek(0);//輸出指標移至最左端
-    sendOut<<totalBytes<<qint64((outBlock.size()-sizeof(qint64)*2));//<<前面總長度,後面檔案名稱的長度
-    bytesToWrite = totalBytes - ServerConnection->write(outBlock);//尚未傳送的bytes數
-    qDebug()<<"totalBytes"<<totalBytes;
-    outBlock.resize(0);//清空outBlock
-}
-
-void MainWindow::updateClientProgress(qint64 numBytes){
-    qDebug()<<"[PIT]updateClientProgress";
-    qDebug()<<"updateClientProgress"<<numBytes;
-    bytesWritten += (int)numBytes;
-    if(bytesToWrite > 0){
-        //從檔案讀取Raw data, 儲存在outBlock中
-        outBlock = LF->read(qMin(bytesToWrite,loadSize));
-        //將outBlock的資料寫出去(資料網路)
-        bytesToWrite -= (int)ServerConnection->write(outBlock);
-        outBlock.resize(0);
-    }else{
-        disconnect(ServerConnection,SIGNAL(bytesWritten(qint64)),this,SLOT(updateClientProgress(qint64)));
-        LF->close();
-    }
-}
 void MainWindow::setClipboardContent(){
     QClipboard *board = QApplication::clipboard();
     ui->CopyButton->setEnabled(false);
@@ -25,15 +25,22 @@
 #include <QCloseEvent>
 #include <QProcess>
 #include <QFileSystemWatcher>
-#include <QSettings>
 #include <QLabel>
 #include <QtNetwork>
-#include <QTimer>
+#include <QThread>
+#include <QElapsedTimer>
+
+#include "consolebuffer.h"
 
 namespace Ui {
 class MainWindow;
 }
 
+class ConsoleModel;
+class ConsoleExporter;
+class QProgressDialog;
+class ServerController;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -50,44 +57,25 @@ public:
 
     void loadServerProperties();
 
+    void appendConsoleMessage(const QString& text, int style);
+
     QString htmlColor(const QString& msg, const QString& color);
     QString htmlBlue(const QString& msg);
     QString htmlRed(const QString& msg);
     QString htmlGreen(const QString& msg);
     QString htmlPurple(const QString& msg);
 
-    void setMinecraftServerPath(const QString& mcServerPath) {m_mcServerPath = mcServerPath;}
-    QString getMinecraftServerPath() {return m_mcServerPath;}
-
-    void setCustomJavaPath(const QString& customJavaPath) {m_customJavaPath = customJavaPath;}
-    QString getCustomJavaPath() {return m_customJavaPath;}
-
-    void setUseCustomJavaPath(bool useCustomJavaPath) {m_useCustomJavaPath = useCustomJavaPath;}
-    bool useCustomJavaPath() {return m_useCustomJavaPath;}
-
-    void setAdditionalParameters(const QString& additionalParameters) {m_additionalParameters = additionalParameters;}
-    QString getAdditionalParameters() {return m_additionalParameters;}
-
-    void setXms(int xms) {m_xms = xms;}
-    int getXms() {return m_xms;}
-
-    void setXmx(int xmx) {m_xmx = xmx;}
-    int getXmx() {return m_xmx;}
-
     QString getMinecraftServerPropertiesPath(const QString& mcServerPath);
     QString getMinecraftServerWorkingDirectoryPath(const QString& mcServerPath);
 
     void updateWatchedFileSystemPath(const QString& oldPath, const QString& newPath);
     void updateWatchedDirSystemPath(const QString& oldPath, const QString& newPath);
 
-    //===2018new===
-    QString getMinecraftLogsPath(const QString& mcServerPath);
-
 public slots:
     void onStart();
     void onFinish(int exitCode, QProcess::ExitStatus exitStatus);
-    void onStandardOutput();
-    void onStandardError();
+    void onExportProgress(int percent);
+    void onExportFinished(int result, qint64 lines);
     void onWatchedFileChanged(const QString& path);
     void onWatchedDirChanged(const QString& path);
 
@@ -98,13 +86,14 @@ private:
     void createActions();
     void createTrayIcon();
     void setIcon();
+    bool isConsoleAtBottom();
+    void findInConsole(bool backwards);
     //===2018new===
     void serverStart();
-    void keyAlgorithm();
     void writeToFile(QString FileNameT, QString strT);
-    void prepareSend();
 
 private slots:
+    void appendConsoleLines(const QVector<ConsoleLine>& lines);
     void iconActivated(QSystemTrayIcon::ActivationReason reason);
     void on_actionAbout_triggered();
     void on_actionExit_triggered();
@@ -115,21 +104,23 @@ private slots:
     void on_serverCommandLineEdit_returnPressed();
     void on_actionClear_triggered();
     void on_actionExport_triggered();
+    void copyConsoleSelection();
+    void on_actionFind_triggered();
+    void on_searchLineEdit_returnPressed();
+    void on_searchNextButton_clicked();
+    void on_searchPreviousButton_clicked();
     void on_serverCommandLineEdit_textEdited(const QString &text);
     void on_actionSaveServerProperties_triggered();
     void on_actionRefreshServerProperties_triggered();
     //===2018new===
-    void acceptConnection();
-    void readMessage();
-    void serverDisconnected();
+    void onRemoteLog(const QString& text, int kind);
+    void onRemoteSessionsChanged(int sessions, int authenticated);
     void generateKey();
     void refreshKey_slot();
     void forceDisconnect();
     void restartServer();
     void cleanRemoteServerLog();
     void ExportRemoteServerLog();
-    void timerTimeout();
-    void updateClientProgress(qint64 numBytes);
     void setClipboardContent();
 private:
     Ui::MainWindow *ui;
@@ -149,41 +140,22 @@ private:
     QMenu *trayIconMenu;
 
     bool m_bTrayWarningShowed;
-    QProcess *m_pServerProcess;
+    ServerController* m_pController;
     QFileSystemWatcher* m_pFileSystemWatcher;
     QFileSystemWatcher* m_pDirSystemWatcher;
 
-    QSettings* m_pSettings;
-    QString m_customJavaPath;
-    QString m_mcServerPath;
-    bool m_useCustomJavaPath;
-    int m_xms;
-    int m_xmx;
-    QString m_additionalParameters;
-    //===2018new===
-    QByteArray connectKeyBA;
-    QTcpServer Server;
-    QTcpSocket *ServerConnection;
-    quint16    ServerPort;
-    QString    ClientIPaddress;
-    quint16    ClientPort;
-    bool       firstConnect;
-    QTimer*    firstConnectTimer;
-
-    qint64       totalBytes;//record data totalBytes
-    qint64       bytesWritten;//record Written data Bytes now
-    qint64       bytesToWrite;//record havn't written data Bytes now
-    qint64       loadSize;//record every data's size
-    QFile        *LF;//localFile
-    QByteArray   outBlock;//data output staging
-
-    QString      MCServerLogs;
-    QString      MCServerLogsTemp;
-    qint64       MCServerLogsSize;
-    QString      sendFileMode;
-    QString      outBlockText;
+    ConsoleModel* m_pConsoleModel;
 
+    QThread* m_pExportThread;
+    ConsoleExporter* m_pExporter;
+    QProgressDialog* m_pExportProgress;
 
+    QVector<quint64> m_searchHits;
+    int m_searchHitIndex;
+    QString m_searchPattern;
+    bool m_searchRegex;
+    //===2018new===
+    int m_remoteSessions;
 };
 
 #endif // MAINWINDOW_H
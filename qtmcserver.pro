@@ -57,19 +57,29 @@ SOURCES += main.cpp\
     licensedialog.cpp \
     aboutdialog.cpp \
     settingsdialog.cpp \
-    downloaddialog.cpp
+    downloaddialog.cpp \
+    exportdialog.cpp
 
 HEADERS  += mainwindow.h \
     licensedialog.h \
     aboutdialog.h \
     settingsdialog.h \
-    downloaddialog.h
+    downloaddialog.h \
+    exportdialog.h
+
+# process control, console pipeline and remote server, shared with the
+# headless daemon in daemon/
+include(core.pri)
+
+# scrollback model and search, shared with the benchmarks
+include(consoleview.pri)
 
 FORMS    += mainwindow.ui \
     licensedialog.ui \
     aboutdialog.ui \
     settingsdialog.ui \
-    downloaddialog.ui
+    downloaddialog.ui \
+    exportdialog.ui
 
 RESOURCES += \
     qtmcserver.qrc
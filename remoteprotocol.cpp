@@ -0,0 +1,268 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "remoteprotocol.h"
+
+#include <QtEndian>
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
+
+#include <string.h>
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+// consumed bytes are dropped from the front once this many piled up
+#define COMPACT_SIZE (64 * 1024)
+
+#define ZLIB_CHUNK_SIZE (16 * 1024)
+
+void encodeFrame(QByteArray &out, quint8 type, const QByteArray &payload, quint32 requestId, quint8 flags)
+{
+    encodeFrameHeader(out, type, payload.size(), requestId, flags);
+    out.append(payload);
+}
+
+void encodeFrameHeader(QByteArray &out, quint8 type, int payloadSize, quint32 requestId, quint8 flags)
+{
+    int start = out.size();
+    out.resize(start + RemoteProtocol::HEADER_SIZE);
+
+    uchar* header = reinterpret_cast<uchar*>(out.data() + start);
+    qToBigEndian<quint32>(quint32(payloadSize), header);
+    header[4] = type;
+    header[5] = flags;
+    qToBigEndian<quint32>(requestId, header + 6);
+}
+
+QByteArray connectionKey(const QDateTime &time)
+{
+    return QCryptographicHash::hash(time.toString("yyyy/MM/dd-HH:mm").toLatin1(), QCryptographicHash::Sha3_512);
+}
+
+QByteArray challengeResponse(const QByteArray &key, const QByteArray &nonce)
+{
+    return QMessageAuthenticationCode::hash(nonce, key, QCryptographicHash::Sha256);
+}
+
+bool constantTimeEquals(const QByteArray &a, const QByteArray &b)
+{
+    // the lengths are no secret
+    if(a.size() != b.size())
+        return false;
+
+    uchar difference = 0;
+    for(int i = 0; i < a.size(); i++)
+    {
+        difference |= uchar(a.at(i)) ^ uchar(b.at(i));
+    }
+
+    return difference == 0;
+}
+
+QByteArray randomBytes(int size)
+{
+    // the system's entropy source, std::random_device may be a fixed
+    // sequence on some toolchains
+    QRandomGenerator* generator = QRandomGenerator::system();
+    QByteArray bytes(size, 0);
+
+    for(int i = 0; i < size; i += 4)
+    {
+        quint32 value = generator->generate();
+        memcpy(bytes.data() + i, &value, qMin(4, size - i));
+    }
+
+    return bytes;
+}
+
+FrameDecoder::FrameDecoder()
+{
+    m_offset = 0;
+    m_error = false;
+}
+
+void FrameDecoder::append(const QByteArray &data)
+{
+    if(m_offset >= COMPACT_SIZE || m_offset == m_buffer.size())
+    {
+        m_buffer.remove(0, m_offset);
+        m_offset = 0;
+    }
+
+    m_buffer.append(data);
+}
+
+bool FrameDecoder::next(RemoteFrame &frame)
+{
+    if(m_error || m_buffer.size() - m_offset < RemoteProtocol::HEADER_SIZE)
+        return false;
+
+    const uchar* header = reinterpret_cast<const uchar*>(m_buffer.constData() + m_offset);
+    quint32 size = qFromBigEndian<quint32>(header);
+
+    if(size > quint32(RemoteProtocol::MAX_PAYLOAD_SIZE))
+    {
+        m_error = true;
+        return false;
+    }
+
+    // wait for the rest of the payload
+    if(m_buffer.size() - m_offset - RemoteProtocol::HEADER_SIZE < int(size))
+        return false;
+
+    frame.type = header[4];
+    frame.flags = header[5];
+    frame.requestId = qFromBigEndian<quint32>(header + 6);
+    frame.payload = m_buffer.mid(m_offset + RemoteProtocol::HEADER_SIZE, int(size));
+
+    m_offset += RemoteProtocol::HEADER_SIZE + int(size);
+    return true;
+}
+
+void FrameDecoder::clear()
+{
+    m_buffer.clear();
+    m_offset = 0;
+    m_error = false;
+}
+
+FrameDeflater::FrameDeflater()
+{
+    m_pStream = 0;
+}
+
+FrameDeflater::~FrameDeflater()
+{
+    if(m_pStream)
+    {
+        deflateEnd(m_pStream);
+        delete m_pStream;
+    }
+}
+
+bool FrameDeflater::start(int level)
+{
+    if(m_pStream)
+        return true;
+
+    m_pStream = new z_stream;
+    memset(m_pStream, 0, sizeof(z_stream));
+
+    if(deflateInit(m_pStream, level) != Z_OK)
+    {
+        delete m_pStream;
+        m_pStream = 0;
+        return false;
+    }
+
+    return true;
+}
+
+QByteArray FrameDeflater::deflate(const QByteArray &data)
+{
+    QByteArray out;
+
+    if(!m_pStream)
+        return out;
+
+    m_pStream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    m_pStream->avail_in = uInt(data.size());
+
+    // a sync flush ends the payload on a byte boundary without ending the stream
+    do
+    {
+        int size = out.size();
+        out.resize(size + ZLIB_CHUNK_SIZE);
+
+        m_pStream->next_out = reinterpret_cast<Bytef*>(out.data() + size);
+        m_pStream->avail_out = ZLIB_CHUNK_SIZE;
+
+        ::deflate(m_pStream, Z_SYNC_FLUSH);
+
+        out.resize(out.size() - int(m_pStream->avail_out));
+    }
+    while(m_pStream->avail_out == 0);
+
+    return out;
+}
+
+FrameInflater::FrameInflater()
+{
+    m_pStream = 0;
+}
+
+FrameInflater::~FrameInflater()
+{
+    if(m_pStream)
+    {
+        inflateEnd(m_pStream);
+        delete m_pStream;
+    }
+}
+
+bool FrameInflater::start()
+{
+    if(m_pStream)
+        return true;
+
+    m_pStream = new z_stream;
+    memset(m_pStream, 0, sizeof(z_stream));
+
+    if(inflateInit(m_pStream) != Z_OK)
+    {
+        delete m_pStream;
+        m_pStream = 0;
+        return false;
+    }
+
+    return true;
+}
+
+bool FrameInflater::inflate(const QByteArray &data, QByteArray &out)
+{
+    out.clear();
+
+    if(!m_pStream)
+        return false;
+
+    m_pStream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    m_pStream->avail_in = uInt(data.size());
+
+    do
+    {
+        int size = out.size();
+        out.resize(size + ZLIB_CHUNK_SIZE);
+
+        m_pStream->next_out = reinterpret_cast<Bytef*>(out.data() + size);
+        m_pStream->avail_out = ZLIB_CHUNK_SIZE;
+
+        int result = ::inflate(m_pStream, Z_SYNC_FLUSH);
+
+        out.resize(out.size() - int(m_pStream->avail_out));
+
+        if(result != Z_OK && result != Z_BUF_ERROR)
+            return false;
+    }
+    while(m_pStream->avail_out == 0);
+
+    return true;
+}
@@ -0,0 +1,189 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REMOTEPROTOCOL_H
+#define REMOTEPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QDateTime>
+
+struct z_stream_s;
+typedef struct z_stream_s z_stream;
+
+// Remote control protocol on port 7777. Every message is one frame:
+//
+//   quint32 payload size | quint8 type | quint8 flags | quint32 request id | payload
+//
+// all big-endian. Text payloads are UTF-8, structured ones are written
+// with QDataStream (Qt_5_9). A reply carries the request id of the frame
+// it answers, frames the server sends on its own carry 0.
+namespace RemoteProtocol
+{
+    enum MessageType
+    {
+        Key = 1,            // client: connection key in the clear, deprecated, for clients without Challenge
+        Remote,             // server: verification result
+        Reason,             // server: why a request failed
+        Button,             // client: "start" or "stop"
+        Command,            // client: console command for the server
+        ServerStatus,       // client asks, server answers with the status text
+        ServerLogs,         // client asks, server answers with the console
+        LogsUpdate,         // client asks, server answers with what is new
+        FileHeader,         // client: optional qint64 offset, qint64 length (-1 to the end),
+                            // QString log file name (latest.log when empty)
+                            // server: qint64 file size, QString name, qint64 offset, qint64 length
+        FileData,           // server: raw file bytes of the range, in order
+        FileEnd,            // server: QByteArray SHA-256 of the file up to the end of the range
+        Subscribe,          // client: qint64 first sequence wanted, -1 for new lines only
+                            // server: quint64 first and next sequence it holds
+        Unsubscribe,        // client: stop pushing console lines
+        LogLines,           // server: quint32 count, then per line quint64 sequence,
+                            // qint64 timestamp, quint8 level, quint8 style, QString text
+        Hello,              // client: quint32 capabilities it supports
+                            // server: quint32 capabilities turned on for the session
+        LogList,            // client asks, server answers quint32 count, then per file
+                            // QString name, qint64 size, qint64 modified (msecs since epoch)
+        LogGrep,            // client: QString name, qint64 from, qint64 to (msecs, -1 open),
+                            // qint32 minimum level, QString text, quint32 max lines (0 all)
+                            // server: QStringList of matching lines, as many frames as needed
+        LogGrepEnd,         // server: quint64 lines scanned, quint64 lines matched, QString error
+        Batch,              // client: QStringList console commands
+                            // server: quint32 commands run, quint32 skipped, QString error
+        Challenge,          // client asks, server answers with a fresh nonce
+        Response,           // client: HMAC-SHA256 of the nonce with the connection key
+        Resume              // client: QByteArray token, qint64 first sequence wanted (-1 where it was)
+                            // server: after Response or Resume succeeded, QByteArray token
+                            // for the next reconnect, qint32 seconds it is kept after a drop
+    };
+
+    enum Capability
+    {
+        CapDeflate = 0x01   // larger server payloads come as one zlib stream
+    };
+
+    enum FrameFlag
+    {
+        FlagCompressed = 0x01
+    };
+
+    enum
+    {
+        HEADER_SIZE = 10,
+        MAX_PAYLOAD_SIZE = 16 * 1024 * 1024,
+        NONCE_SIZE = 32,
+        TOKEN_SIZE = 32
+    };
+}
+
+struct RemoteFrame
+{
+    RemoteFrame() :
+        type(0),
+        flags(0),
+        requestId(0)
+    {
+    }
+
+    quint8 type;
+    quint8 flags;
+    quint32 requestId;
+    QByteArray payload;
+
+    QString text() const {return QString::fromUtf8(payload);}
+};
+
+// Appends one encoded frame to out.
+void encodeFrame(QByteArray& out, quint8 type, const QByteArray& payload, quint32 requestId = 0, quint8 flags = 0);
+
+// Appends just the header, for a payload written out separately.
+void encodeFrameHeader(QByteArray& out, quint8 type, int payloadSize, quint32 requestId = 0, quint8 flags = 0);
+
+// Connection key for the given minute, SHA3-512 of "yyyy/MM/dd-HH:mm".
+// The server takes the minute its key was last refreshed.
+QByteArray connectionKey(const QDateTime& time);
+
+// What a client answers a Challenge with.
+QByteArray challengeResponse(const QByteArray& key, const QByteArray& nonce);
+
+// Compares in the same time whatever the contents, for keys and tokens.
+bool constantTimeEquals(const QByteArray& a, const QByteArray& b);
+
+// Nonces and resume tokens.
+QByteArray randomBytes(int size);
+
+// One zlib stream spread over the compressed frames of a connection.
+// Each payload is flushed on its own, but later ones refer back to
+// earlier ones, so they must be inflated in the order they were sent.
+class FrameDeflater
+{
+public:
+    FrameDeflater();
+    ~FrameDeflater();
+
+    bool start(int level);
+    bool isStarted() const {return m_pStream != 0;}
+
+    QByteArray deflate(const QByteArray& data);
+
+private:
+    Q_DISABLE_COPY(FrameDeflater)
+
+    z_stream* m_pStream;
+};
+
+class FrameInflater
+{
+public:
+    FrameInflater();
+    ~FrameInflater();
+
+    bool start();
+    bool isStarted() const {return m_pStream != 0;}
+
+    // false when the data is not part of the stream
+    bool inflate(const QByteArray& data, QByteArray& out);
+
+private:
+    Q_DISABLE_COPY(FrameInflater)
+
+    z_stream* m_pStream;
+};
+
+// Cuts frames out of a byte stream however TCP splits or joins them.
+class FrameDecoder
+{
+public:
+    FrameDecoder();
+
+    void append(const QByteArray& data);
+
+    // false when no complete frame is buffered, or after an error
+    bool next(RemoteFrame& frame);
+
+    // set when a frame announced more than MAX_PAYLOAD_SIZE
+    bool hasError() const {return m_error;}
+
+    void clear();
+
+private:
+    QByteArray m_buffer;
+    int m_offset;
+    bool m_error;
+};
+
+#endif // REMOTEPROTOCOL_H
@@ -0,0 +1,1286 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "remoteserver.h"
+#include "statusserver.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QtEndian>
+
+// a client has this long to present the key
+#define AUTH_TIMEOUT 3000
+
+// challenges and resume attempts before that, a client needs two at most
+#define MAX_AUTH_ATTEMPTS 4
+
+// a dropped client may resume with its token for this long
+#define RESUME_LIFETIME 60000
+#define MAX_PARKED_SESSIONS 64
+
+// further connections are refused right away
+#define MAX_SESSIONS 64
+
+#define FILE_CHUNK_SIZE (256 * 1024)
+
+// lines per LogLines frame
+#define MAX_PUSH_LINES 512
+
+// log bytes read per grep step, other clients get their turn in between
+#define SCAN_STEP_SIZE (256 * 1024)
+
+// smaller payloads are not worth compressing
+#define COMPRESS_THRESHOLD 256
+#define COMPRESS_LEVEL 6
+
+// output queue per client: log pushes pause above the high watermark and
+// resume below the low one, a client that lets the queue grow past the
+// limit is dropped
+#define HIGH_WATERMARK (1024 * 1024)
+#define LOW_WATERMARK (256 * 1024)
+#define MAX_QUEUE_SIZE (16 * 1024 * 1024)
+
+// requests queued per client before its socket is no longer read, the
+// socket's read buffer then fills up and TCP makes the client wait
+#define MAX_QUEUED_REQUESTS 256
+#define READ_BUFFER_SIZE (256 * 1024)
+
+// the scheduler gives the event loop back after this many milliseconds
+#define REQUEST_SLICE 10
+
+// console commands from all clients together, per second and burst
+#define COMMAND_RATE 100
+#define COMMAND_BURST 200
+
+// console commands per client, per second and burst
+#define CLIENT_COMMAND_RATE 20
+#define CLIENT_COMMAND_BURST 40
+
+// a larger batch is refused, the client's bucket could never pay it
+// off in one go and would forgive the rest as debt
+#define MAX_BATCH_COMMANDS CLIENT_COMMAND_BURST
+
+// the whole console is rendered for it, the other log requests cost 1
+#define SERVER_LOGS_COST 10
+
+// per client and request class, requests per second and burst
+static const double REQUEST_RATES[RemoteSession::RequestClassCount][2] =
+{
+    {1, 3},         // RequestControl
+    {CLIENT_COMMAND_RATE, CLIENT_COMMAND_BURST},   // RequestCommand
+    {10, 20},       // RequestLogs
+    {2, 4},         // RequestFile
+    {50, 100}       // RequestQuery
+};
+
+// the count is checked before the list is read, a forged one neither
+// allocates nor gets charged
+static bool decodeBatch(const QByteArray& payload, QStringList& commands, QString& error)
+{
+    if(payload.size() < 4)
+    {
+        error = "malformed batch";
+        return false;
+    }
+
+    if(qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(payload.constData())) > MAX_BATCH_COMMANDS)
+    {
+        error = QString("more than %1 commands in a batch").arg(MAX_BATCH_COMMANDS);
+        return false;
+    }
+
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_5_9);
+    in >> commands;
+
+    if(in.status() != QDataStream::Ok)
+    {
+        commands.clear();
+        error = "malformed batch";
+        return false;
+    }
+
+    return true;
+}
+
+// one line each, a line break would smuggle in another command
+static QStringList acceptedCommands(const QStringList& commands)
+{
+    QStringList accepted;
+
+    foreach(const QString& command, commands)
+    {
+        if(!command.trimmed().isEmpty() && !command.contains('\n') && !command.contains('\r'))
+            accepted.append(command);
+    }
+
+    return accepted;
+}
+
+RemoteSession::RemoteSession(int id, QTcpSocket *socket, RemoteServer *server) :
+    QObject(server)
+{
+    m_id = id;
+    m_state = Authenticating;
+    m_pServer = server;
+    m_pSocket = socket;
+    m_pSocket->setParent(this);
+    m_peer = QString("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
+    m_consoleSent = false;
+    m_consoleSequence = 0;
+    m_subscribed = false;
+    m_pushSequence = 0;
+    m_congested = false;
+    m_requestId = 0;
+    m_transferRequestId = 0;
+    m_grepRequestId = 0;
+    m_grepLimit = 0;
+    m_readPaused = false;
+    m_authAttempts = 0;
+
+    for(int i = 0; i < RequestClassCount; i++)
+    {
+        m_buckets[i].setRate(REQUEST_RATES[i][0], REQUEST_RATES[i][1]);
+    }
+
+    m_pSocket->setReadBufferSize(READ_BUFFER_SIZE);
+
+    m_authTimer.setSingleShot(true);
+    m_authTimer.start(AUTH_TIMEOUT);
+
+    connect( &m_authTimer, SIGNAL(timeout()), SLOT(onAuthTimeout()) );
+
+    m_scanTimer.setSingleShot(true);
+    connect( &m_scanTimer, SIGNAL(timeout()), SLOT(scanLogs()) );
+    connect( m_pSocket, SIGNAL(readyRead()), SLOT(onReadyRead()) );
+    connect( m_pSocket, SIGNAL(disconnected()), SLOT(onDisconnected()) );
+    connect( m_pSocket, SIGNAL(bytesWritten(qint64)), SLOT(onBytesWritten(qint64)) );
+}
+
+RemoteSession::~RemoteSession()
+{
+}
+
+void RemoteSession::send(quint8 type, const QByteArray &payload, quint32 requestId)
+{
+    if(m_state == Closing)
+        return;
+
+    QByteArray frame;
+    encode(frame, type, payload, requestId);
+    write(frame);
+}
+
+void RemoteSession::write(const QByteArray &frame, const QByteArray &payload)
+{
+    if(m_state == Closing)
+        return;
+
+    // checked before writing, a single large reply is always let through
+    if(m_pSocket->bytesToWrite() > MAX_QUEUE_SIZE)
+    {
+        log(QString("Slow client, %1KB not read, disconnected").arg(m_pSocket->bytesToWrite() / 1024), RemoteServer::LogError);
+        m_state = Closing;
+        m_pSocket->abort();
+        onDisconnected();
+        return;
+    }
+
+    // the socket buffers what the kernel does not take yet, nothing waits here
+    m_pSocket->write(frame);
+    if(!payload.isEmpty())
+        m_pSocket->write(payload);
+
+    if(m_pSocket->bytesToWrite() >= HIGH_WATERMARK)
+        m_congested = true;
+}
+
+void RemoteSession::reply(quint8 type, const QByteArray &payload)
+{
+    send(type, payload, m_requestId);
+}
+
+void RemoteSession::encode(QByteArray &out, quint8 type, const QByteArray &payload, quint32 requestId)
+{
+    if(m_deflater.isStarted() && payload.size() >= COMPRESS_THRESHOLD)
+        encodeFrame(out, type, m_deflater.deflate(payload), requestId, RemoteProtocol::FlagCompressed);
+    else
+        encodeFrame(out, type, payload, requestId);
+}
+
+void RemoteSession::close(const QByteArray &reason)
+{
+    if(m_state == Closing)
+        return;
+
+    if(!reason.isEmpty())
+        send(RemoteProtocol::Remote, reason, m_requestId);
+
+    m_state = Closing;
+    m_authTimer.stop();
+    m_decoder.clear();
+    m_queue.clear();
+    m_pSocket->disconnectFromHost();
+
+    // already gone when nothing was left to write
+    if(m_pSocket->state() == QAbstractSocket::UnconnectedState)
+        onDisconnected();
+}
+
+void RemoteSession::pushLines()
+{
+    // a congested client catches up from its cursor once the queue drains
+    if(!m_subscribed || m_congested || m_state != Authenticated)
+        return;
+
+    const ConsoleBuffer& console = m_pServer->console();
+
+    // lines dropped from the buffer or the ingester before they were
+    // sent are skipped, the client sees the gap in the sequence numbers
+    while(m_pushSequence < console.nextSequence())
+    {
+        int first = console.indexOf(m_pushSequence);
+
+        // cleared since, nothing left to catch up on
+        if(first >= console.size())
+        {
+            m_pushSequence = console.nextSequence();
+            break;
+        }
+
+        int count = qMin(console.size() - first, MAX_PUSH_LINES);
+
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_9);
+        out << quint32(count);
+
+        for(int i = first; i < first + count; i++)
+        {
+            const ConsoleLine& line = console.at(i);
+            out << line.sequence << line.timestamp << line.event.level << line.style << line.text;
+        }
+
+        m_pushSequence = console.at(first + count - 1).sequence + 1;
+        send(RemoteProtocol::LogLines, payload);
+
+        if(m_congested || m_state != Authenticated)
+            break;
+    }
+}
+
+qint64 RemoteSession::runNext(qint64 now)
+{
+    if(m_queue.isEmpty() || m_state == Closing)
+        return -1;
+
+    const QueuedRequest& request = m_queue.head();
+    TokenBucket& bucket = m_buckets[request.requestClass];
+    bool command = (request.requestClass == RequestCommand);
+
+    qint64 wait = bucket.wait(request.cost, now);
+    if(command)
+        wait = qMax(wait, m_pServer->m_commandBucket.wait(request.cost, now));
+
+    // in order, whatever the client sent after it waits as well
+    if(wait > 0)
+        return wait;
+
+    bucket.take(request.cost, now);
+    if(command)
+        m_pServer->m_commandBucket.take(request.cost, now);
+
+    RemoteFrame frame = m_queue.dequeue().frame;
+    handleFrame(frame);
+
+    if(m_readPaused && m_state != Closing && m_queue.size() <= MAX_QUEUED_REQUESTS / 2)
+    {
+        m_readPaused = false;
+        readFrames();
+    }
+
+    return 0;
+}
+
+void RemoteSession::onReadyRead()
+{
+    if(!m_readPaused)
+        readFrames();
+}
+
+void RemoteSession::readFrames()
+{
+    m_decoder.append(m_pSocket->readAll());
+
+    // TCP may hand over half a frame or several at once
+    RemoteFrame frame;
+    while(m_state != Closing && m_queue.size() < MAX_QUEUED_REQUESTS && m_decoder.next(frame))
+    {
+        // the key is checked right away, the auth timer is running
+        if(m_state == Authenticating)
+            handleFrame(frame);
+        else
+            enqueue(frame);
+    }
+
+    if(m_decoder.hasError())
+    {
+        log("\"frame too large\"", RemoteServer::LogError);
+        close();
+        return;
+    }
+
+    // the rest stays in the decoder and the socket until the queue drains
+    if(m_queue.size() >= MAX_QUEUED_REQUESTS && !m_readPaused)
+    {
+        m_readPaused = true;
+        log("Too many requests, reading paused", RemoteServer::LogNotice);
+    }
+
+    if(!m_queue.isEmpty())
+        m_pServer->queueRequests();
+}
+
+void RemoteSession::enqueue(const RemoteFrame &frame)
+{
+    QueuedRequest request;
+    request.frame = frame;
+    request.requestClass = RequestQuery;
+    request.cost = 1;
+
+    switch(frame.type)
+    {
+    case RemoteProtocol::Button:
+        request.requestClass = RequestControl;
+        break;
+
+    case RemoteProtocol::Command:
+        request.requestClass = RequestCommand;
+        break;
+
+    case RemoteProtocol::Batch:
+    {
+        // paid per command that will run, a rejected batch costs 1
+        request.requestClass = RequestCommand;
+
+        QStringList commands;
+        QString error;
+        if(decodeBatch(frame.payload, commands, error))
+            request.cost = qMax(1, acceptedCommands(commands).size());
+        break;
+    }
+
+    case RemoteProtocol::ServerLogs:
+        request.requestClass = RequestLogs;
+        request.cost = SERVER_LOGS_COST;
+        break;
+
+    case RemoteProtocol::LogsUpdate:
+    case RemoteProtocol::LogList:
+    case RemoteProtocol::LogGrep:
+        request.requestClass = RequestLogs;
+        break;
+
+    case RemoteProtocol::FileHeader:
+        request.requestClass = RequestFile;
+        break;
+
+    default:
+        break;
+    }
+
+    m_queue.enqueue(request);
+}
+
+void RemoteSession::onDisconnected()
+{
+    disconnect( m_pSocket, 0, this, 0 );
+    m_state = Closing;
+    m_authTimer.stop();
+    m_queue.clear();
+
+    // the client may have left in the middle of a file transfer
+    m_transfer.close();
+    m_scanner.close();
+
+    emit closed(this);
+}
+
+void RemoteSession::onAuthTimeout()
+{
+    log("Reason : Verification fail(Timeout)", RemoteServer::LogNotice);
+    close("Verification fail|Timeout");
+}
+
+void RemoteSession::onBytesWritten(qint64 bytes)
+{
+    Q_UNUSED(bytes);
+
+    if(m_congested && m_pSocket->bytesToWrite() <= LOW_WATERMARK)
+    {
+        // what piled up meanwhile goes out in as few frames as possible
+        m_congested = false;
+        pushLines();
+    }
+
+    sendFileChunk();
+
+    if(m_scanner.isOpen())
+        scheduleScan();
+}
+
+void RemoteSession::handleFrame(const RemoteFrame &frame)
+{
+    // replies carry the id of the request, pushes carry 0
+    m_requestId = frame.requestId;
+    dispatch(frame);
+    m_requestId = 0;
+}
+
+void RemoteSession::dispatch(const RemoteFrame &frame)
+{
+    if(m_state == Authenticating)
+    {
+        authenticate(frame);
+        return;
+    }
+
+    QString text = frame.text();
+
+    switch(frame.type)
+    {
+    case RemoteProtocol::Key:
+        break;
+
+    case RemoteProtocol::Button:
+        if(text == "start")
+        {
+            emit m_pServer->startRequested();
+            log("PushButton\"start\"", RemoteServer::LogPlain);
+        }
+        else if(text == "stop")
+        {
+            emit m_pServer->stopRequested();
+            log("PushButton\"stop\"", RemoteServer::LogPlain);
+        }
+        break;
+
+    case RemoteProtocol::Command:
+        if(text == "texttest")
+            break;
+
+        if(!m_pServer->isServerRunning())
+            reply(RemoteProtocol::Reason, "Send Command Error Occur!!Reason : Server isn't running.");
+        else
+            emit m_pServer->commandsReceived(QStringList() << text);
+
+        log("ReceiveCommand\"" + text + "\"", RemoteServer::LogPlain);
+        break;
+
+    case RemoteProtocol::Batch:
+        runBatch(frame);
+        break;
+
+    case RemoteProtocol::FileHeader:
+        startFileTransfer(frame);
+        break;
+
+    case RemoteProtocol::LogList:
+        sendLogList();
+        break;
+
+    case RemoteProtocol::LogGrep:
+        startLogGrep(frame);
+        break;
+
+    case RemoteProtocol::ServerStatus:
+        reply(RemoteProtocol::ServerStatus, QDateTime::currentDateTime().toString("yyyy/MM/dd hh:mm:ss ").toUtf8() +
+                                           m_pServer->serverStatus().toUtf8());
+        log("PushButton\"get mcServerStatus\"", RemoteServer::LogPlain);
+        break;
+
+    case RemoteProtocol::ServerLogs:
+        sendConsole();
+        break;
+
+    case RemoteProtocol::LogsUpdate:
+        sendConsoleUpdate();
+        break;
+
+    case RemoteProtocol::Hello:
+        negotiate(frame);
+        break;
+
+    case RemoteProtocol::Subscribe:
+        subscribe(frame);
+        break;
+
+    case RemoteProtocol::Unsubscribe:
+        m_subscribed = false;
+        log("Unsubscribed", RemoteServer::LogPlain);
+        break;
+
+    default:
+        log("\"error format\"->" + QString::number(frame.type), RemoteServer::LogError);
+        break;
+    }
+}
+
+void RemoteSession::runBatch(const RemoteFrame &frame)
+{
+    QStringList commands;
+    QStringList accepted;
+    QString error;
+
+    if(decodeBatch(frame.payload, commands, error))
+    {
+        if(!m_pServer->isServerRunning())
+        {
+            error = "Server isn't running.";
+        }
+        else
+        {
+            accepted = acceptedCommands(commands);
+
+            if(accepted.size() < commands.size())
+                error = QString("%1 empty or multi-line commands skipped").arg(commands.size() - accepted.size());
+        }
+    }
+
+    // handed to the server in one go, it sees them back to back
+    if(!accepted.isEmpty())
+        emit m_pServer->commandsReceived(accepted);
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << quint32(accepted.size()) << quint32(commands.size() - accepted.size()) << error;
+    reply(RemoteProtocol::Batch, payload);
+
+    log(QString("ReceiveBatch %1 commands").arg(commands.size()), RemoteServer::LogPlain);
+}
+
+void RemoteSession::authenticate(const RemoteFrame &frame)
+{
+    const QByteArray& key = m_pServer->key();
+
+    // handled right away, outside the buckets, so they get a budget of their own
+    if((frame.type == RemoteProtocol::Challenge || frame.type == RemoteProtocol::Resume) &&
+       ++m_authAttempts > MAX_AUTH_ATTEMPTS)
+    {
+        log("Reason : Verification fail(too many attempts)", RemoteServer::LogNotice);
+        close("Verification fail|too many attempts");
+        return;
+    }
+
+    switch(frame.type)
+    {
+    case RemoteProtocol::Challenge:
+        // the auth timer keeps running, a new challenge replaces the old one
+        m_nonce = randomBytes(RemoteProtocol::NONCE_SIZE);
+        reply(RemoteProtocol::Challenge, m_nonce);
+        return;
+
+    case RemoteProtocol::Response:
+    {
+        // a nonce answers once
+        QByteArray nonce = m_nonce;
+        m_nonce.clear();
+
+        if(key.isEmpty() || nonce.isEmpty() || !constantTimeEquals(frame.payload, challengeResponse(key, nonce)))
+            break;
+
+        accept(true);
+        return;
+    }
+
+    case RemoteProtocol::Key:
+        // deprecated, anyone watching the connection learns the key
+        if(!m_pServer->allowsPlainKey())
+        {
+            log("Reason : Verification fail(plain key not allowed)", RemoteServer::LogNotice);
+            close("Verification fail|plain key not allowed");
+            return;
+        }
+
+        if(key.isEmpty() || !constantTimeEquals(frame.payload, key))
+            break;
+
+        accept(false);
+        return;
+
+    case RemoteProtocol::Resume:
+        resume(frame);
+        return;
+
+    default:
+        log("Reason : Verification fail(didn't found any key)", RemoteServer::LogNotice);
+        close("Verification fail|didn't found any key");
+        return;
+    }
+
+    log("Reason : Verification fail(wrong key)", RemoteServer::LogNotice);
+    close("Verification fail|wrong key");
+}
+
+void RemoteSession::accept(bool issueToken)
+{
+    m_state = Authenticated;
+    m_authTimer.stop();
+    log("========Verification Succesful========", RemoteServer::LogInfo);
+    reply(RemoteProtocol::Remote, "success");
+
+    // clients sending the bare key know nothing of tokens
+    if(issueToken)
+    {
+        m_token = randomBytes(RemoteProtocol::TOKEN_SIZE);
+
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_9);
+        out << m_token << qint32(RESUME_LIFETIME / 1000);
+        reply(RemoteProtocol::Resume, payload);
+    }
+
+    m_pServer->notifySessionsChanged();
+}
+
+void RemoteSession::resume(const RemoteFrame &frame)
+{
+    QByteArray token;
+    qint64 from = -1;
+
+    QDataStream in(frame.payload);
+    in.setVersion(QDataStream::Qt_5_9);
+    in >> token >> from;
+
+    RemoteResumeState state;
+    if(in.status() != QDataStream::Ok || !m_pServer->takeResumeState(token, this, state))
+    {
+        // not fatal, the client may still answer a challenge
+        log("Resume fail(unknown or expired token)", RemoteServer::LogNotice);
+        reply(RemoteProtocol::Reason, "Resume fail|unknown or expired token");
+        return;
+    }
+
+    m_consoleSent = state.consoleSent;
+    m_consoleSequence = state.consoleSequence;
+    m_subscribed = state.subscribed;
+    m_pushSequence = state.pushSequence;
+
+    if(from >= 0)
+        m_pushSequence = qMin(quint64(from), m_pServer->console().nextSequence());
+
+    log(QString("Resumed, %1").arg(m_subscribed ? QString("subscribed from #%1").arg(m_pushSequence) : QString("not subscribed")),
+        RemoteServer::LogPlain);
+
+    // a fresh token, the old one is spent
+    accept(true);
+    pushLines();
+}
+
+RemoteResumeState RemoteSession::resumeState() const
+{
+    RemoteResumeState state;
+    state.token = m_token;
+    state.consoleSent = m_consoleSent;
+    state.consoleSequence = m_consoleSequence;
+    state.subscribed = m_subscribed;
+    state.pushSequence = m_pushSequence;
+    return state;
+}
+
+void RemoteSession::sendConsole()
+{
+    const ConsoleBuffer& console = m_pServer->console();
+
+    if(console.isEmpty())
+    {
+        reply(RemoteProtocol::Reason, "mcServerLogs:Didn't Found Any Logs.");
+        return;
+    }
+
+    // updates continue from the line after this reply
+    m_consoleSent = true;
+    m_consoleSequence = console.nextSequence();
+    reply(RemoteProtocol::ServerLogs, console.toHtml().toUtf8());
+    log("successfully send logs", RemoteServer::LogSuccess);
+}
+
+void RemoteSession::sendConsoleUpdate()
+{
+    const ConsoleBuffer& console = m_pServer->console();
+
+    if(!m_consoleSent || m_consoleSequence >= console.nextSequence())
+        return;
+
+    // only the lines since the last reply, dropped ones are skipped
+    int index = console.indexOf(m_consoleSequence);
+
+    m_consoleSequence = console.nextSequence();
+    reply(RemoteProtocol::LogsUpdate, console.toHtml(index, console.size() - index).toUtf8());
+}
+
+void RemoteSession::subscribe(const RemoteFrame &frame)
+{
+    const ConsoleBuffer& console = m_pServer->console();
+
+    qint64 from = -1;
+    if(frame.payload.size() >= 8)
+    {
+        QDataStream in(frame.payload);
+        in.setVersion(QDataStream::Qt_5_9);
+        in >> from;
+    }
+
+    // a reconnecting client resumes after the last line it got, the
+    // reply tells it whether the lines in between are still here
+    m_pushSequence = (from < 0) ? console.nextSequence() : qMin(quint64(from), console.nextSequence());
+    m_subscribed = true;
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << console.firstSequence() << console.nextSequence();
+    reply(RemoteProtocol::Subscribe, payload);
+
+    log(from < 0 ? QString("Subscribed") : QString("Subscribed from #%1").arg(from), RemoteServer::LogPlain);
+
+    pushLines();
+}
+
+void RemoteSession::negotiate(const RemoteFrame &frame)
+{
+    quint32 offered = 0;
+    if(frame.payload.size() >= 4)
+    {
+        QDataStream in(frame.payload);
+        in.setVersion(QDataStream::Qt_5_9);
+        in >> offered;
+    }
+
+    quint32 accepted = 0;
+
+    // once started the stream stays on, the client already holds its state
+    if((offered & RemoteProtocol::CapDeflate) || m_deflater.isStarted())
+    {
+        if(m_deflater.start(COMPRESS_LEVEL))
+            accepted |= RemoteProtocol::CapDeflate;
+    }
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << accepted;
+    reply(RemoteProtocol::Hello, payload);
+
+    log(QString("Capabilities %1").arg(accepted & RemoteProtocol::CapDeflate ? "deflate" : "none"), RemoteServer::LogPlain);
+}
+
+void RemoteSession::startFileTransfer(const RemoteFrame &frame)
+{
+    if(m_transfer.isOpen())
+    {
+        reply(RemoteProtocol::Reason, "file:A transfer is already running.");
+        return;
+    }
+
+    // an interrupted download asks for the rest only
+    qint64 offset = 0;
+    qint64 length = -1;
+    QString name;
+    if(frame.payload.size() >= 16)
+    {
+        QDataStream in(frame.payload);
+        in.setVersion(QDataStream::Qt_5_9);
+        in >> offset >> length;
+        if(!in.atEnd())
+            in >> name;
+    }
+
+    QString path = logFilePath(name);
+    if(path.isEmpty())
+    {
+        reply(RemoteProtocol::Reason, QString("file:No log named %1").arg(name).toUtf8());
+        return;
+    }
+
+    // rotated archives are done with, latest.log and the like are still written
+    if(!m_transfer.open(path, offset, length, path.endsWith(".log.gz")))
+    {
+        reply(RemoteProtocol::Reason, QString("file:Unable to read %1 (%2)").arg(QFileInfo(path).fileName(), m_transfer.errorString()).toUtf8());
+        return;
+    }
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << m_transfer.fileSize() << m_transfer.fileName() << m_transfer.offset() << m_transfer.length();
+
+    m_transferRequestId = m_requestId;
+    send(RemoteProtocol::FileHeader, header, m_transferRequestId);
+
+    log(QString("PushButton\"get logs\" size:%1KB from:%2").arg(m_transfer.length() / 1024.0).arg(offset), RemoteServer::LogPlain);
+
+    sendFileChunk();
+}
+
+void RemoteSession::sendFileChunk()
+{
+    // one chunk in flight is enough to keep the connection busy
+    while(m_transfer.isOpen() && m_state != Closing && m_pSocket->bytesToWrite() <= FILE_CHUNK_SIZE)
+    {
+        if(m_transfer.atEnd())
+        {
+            QByteArray checksum;
+            QDataStream out(&checksum, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_5_9);
+            out << m_transfer.checksum();
+
+            m_transfer.close();
+            send(RemoteProtocol::FileEnd, checksum, m_transferRequestId);
+            return;
+        }
+
+        QByteArray chunk = m_transfer.read(FILE_CHUNK_SIZE);
+
+        if(m_deflater.isStarted())
+        {
+            send(RemoteProtocol::FileData, chunk, m_transferRequestId);
+        }
+        else if(!chunk.isEmpty())
+        {
+            // the chunk points into the mapped file, the socket's buffer is its only copy
+            QByteArray header;
+            encodeFrameHeader(header, RemoteProtocol::FileData, chunk.size(), m_transferRequestId);
+            write(header, chunk);
+        }
+    }
+}
+
+void RemoteSession::sendLogList()
+{
+    QFileInfo latest(m_pServer->logsPath());
+    QFileInfoList files;
+
+    if(!m_pServer->logsPath().isEmpty())
+        files = latest.absoluteDir().entryInfoList(QStringList() << "*.log" << "*.log.gz", QDir::Files, QDir::Name);
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << quint32(files.size());
+
+    foreach(const QFileInfo& file, files)
+    {
+        out << file.fileName() << file.size() << file.lastModified().toMSecsSinceEpoch();
+    }
+
+    reply(RemoteProtocol::LogList, payload);
+    log(QString("PushButton\"list logs\" %1 files").arg(files.size()), RemoteServer::LogPlain);
+}
+
+void RemoteSession::startLogGrep(const RemoteFrame &frame)
+{
+    if(m_scanner.isOpen())
+    {
+        reply(RemoteProtocol::Reason, "grep:A search is already running.");
+        return;
+    }
+
+    QString name;
+    LogFilter filter;
+    qint32 level = 0;
+
+    m_grepRequestId = m_requestId;
+
+    QDataStream in(frame.payload);
+    in.setVersion(QDataStream::Qt_5_9);
+    in >> name >> filter.from >> filter.to >> level >> filter.text >> m_grepLimit;
+    filter.minimumLevel = level;
+
+    QString path = logFilePath(name);
+    if(in.status() != QDataStream::Ok || path.isEmpty())
+    {
+        // nothing was scanned, the counts start over
+        m_scanner.open(QString(), filter);
+        finishLogGrep(QString("No log named %1").arg(name));
+        return;
+    }
+
+    if(!m_scanner.open(path, filter))
+    {
+        finishLogGrep(m_scanner.errorString());
+        return;
+    }
+
+    log(QString("Grep %1 for \"%2\"").arg(name, filter.text), RemoteServer::LogPlain);
+    scheduleScan();
+}
+
+void RemoteSession::scheduleScan()
+{
+    if(!m_scanTimer.isActive())
+        m_scanTimer.start(0);
+}
+
+void RemoteSession::scanLogs()
+{
+    if(!m_scanner.isOpen() || m_state == Closing)
+        return;
+
+    // the matches wait for the client, bytesWritten brings us back
+    if(m_pSocket->bytesToWrite() > FILE_CHUNK_SIZE)
+        return;
+
+    QStringList lines;
+    if(!m_scanner.scan(SCAN_STEP_SIZE, lines))
+    {
+        finishLogGrep(m_scanner.errorString());
+        return;
+    }
+
+    bool limited = m_grepLimit > 0 && m_scanner.matchedLines() >= m_grepLimit;
+    if(limited)
+        lines = lines.mid(0, lines.size() - int(m_scanner.matchedLines() - m_grepLimit));
+
+    if(!lines.isEmpty())
+    {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_9);
+        out << lines;
+        send(RemoteProtocol::LogGrep, payload, m_grepRequestId);
+    }
+
+    if(limited || m_scanner.atEnd())
+    {
+        finishLogGrep(QString());
+        return;
+    }
+
+    // one step at a time, the event loop serves everyone else in between
+    scheduleScan();
+}
+
+void RemoteSession::finishLogGrep(const QString &error)
+{
+    quint64 matched = qMin(m_scanner.matchedLines(), m_grepLimit > 0 ? quint64(m_grepLimit) : m_scanner.matchedLines());
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << m_scanner.scannedLines() << matched << error;
+
+    m_scanner.close();
+    send(RemoteProtocol::LogGrepEnd, payload, m_grepRequestId);
+}
+
+QString RemoteSession::logFilePath(const QString &name) const
+{
+    QFileInfo latest(m_pServer->logsPath());
+    if(name.isEmpty() || m_pServer->logsPath().isEmpty())
+        return latest.filePath();
+
+    // only plain names of logs in the logs directory
+    if(QFileInfo(name).fileName() != name || name.startsWith('.') ||
+       !(name.endsWith(".log") || name.endsWith(".log.gz")))
+        return QString();
+
+    QFileInfo file(latest.absoluteDir(), name);
+    return file.isFile() ? file.absoluteFilePath() : QString();
+}
+
+void RemoteSession::log(const QString &text, int kind)
+{
+    emit m_pServer->logMessage(QString("[#%1 %2] ").arg(m_id).arg(m_peer) + text, kind);
+}
+
+RemoteServer::RemoteServer(QObject *parent) :
+    QObject(parent),
+    m_server(this)
+{
+    m_nextSessionId = 1;
+    m_allowPlainKey = true;
+    m_running = false;
+    m_runningSince = 0;
+    m_serverProcessId = 0;
+    m_requestsQueued = false;
+    m_nextTurn = 0;
+
+    m_clock.start();
+    m_commandBucket.setRate(COMMAND_RATE, COMMAND_BURST);
+
+    m_requestTimer.setSingleShot(true);
+
+    connect( &m_server, SIGNAL(newConnection()), SLOT(onNewConnection()) );
+    connect( &m_requestTimer, SIGNAL(timeout()), SLOT(runRequests()) );
+
+    m_pStatus = new StatusServer(this);
+}
+
+RemoteServer::~RemoteServer()
+{
+    // the sessions go with their parent, no signals on the way out
+    m_server.close();
+}
+
+void RemoteServer::listen(quint16 port)
+{
+    if(m_server.isListening())
+        return;
+
+    if(!m_server.listen(QHostAddress::AnyIPv4, port))
+        emit logMessage(QString("Unable to listen on port %1 (%2)").arg(port).arg(m_server.errorString()), LogError);
+}
+
+void RemoteServer::close()
+{
+    m_server.close();
+    disconnectAll();
+}
+
+void RemoteServer::setServerStatus(const QString &status, bool running)
+{
+    if(running && !m_running)
+        m_runningSince = QDateTime::currentMSecsSinceEpoch();
+
+    m_status = status;
+    m_running = running;
+}
+
+void RemoteServer::listenStatus(quint16 port)
+{
+    if(m_pStatus->isListening())
+        return;
+
+    if(m_pStatus->listen(port))
+        emit logMessage(QString("Status endpoint on http://*:%1/status").arg(port), LogInfo);
+    else
+        emit logMessage(QString("Unable to serve status on port %1 (%2)").arg(port).arg(m_pStatus->errorString()), LogError);
+}
+
+void RemoteServer::closeStatus()
+{
+    m_pStatus->close();
+}
+
+void RemoteServer::setKey(const QByteArray &key)
+{
+    // whoever held a token got it with the old key
+    if(key != m_key)
+        revokeTokens();
+
+    m_key = key;
+}
+
+int RemoteServer::authenticatedCount() const
+{
+    int count = 0;
+
+    foreach(RemoteSession* session, m_sessions)
+    {
+        if(session->state() == RemoteSession::Authenticated)
+            count++;
+    }
+
+    return count;
+}
+
+void RemoteServer::disconnectAll()
+{
+    // dropped on purpose, these do not come back with a token
+    revokeTokens();
+
+    // closing may remove the session from the list right away
+    QList<RemoteSession*> sessions = m_sessions;
+
+    foreach(RemoteSession* session, sessions)
+    {
+        session->close();
+    }
+}
+
+void RemoteServer::appendLines(const QVector<ConsoleLine> &lines)
+{
+    foreach(const ConsoleLine& line, lines)
+    {
+        m_console.append(line);
+    }
+
+    foreach(RemoteSession* session, m_sessions)
+    {
+        session->pushLines();
+    }
+}
+
+void RemoteServer::onNewConnection()
+{
+    while(m_server.hasPendingConnections())
+    {
+        QTcpSocket* socket = m_server.nextPendingConnection();
+
+        if(m_sessions.size() >= MAX_SESSIONS)
+        {
+            emit logMessage(QString("Refused %1:%2, too many connections").arg(socket->peerAddress().toString()).arg(socket->peerPort()), LogError);
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+
+        RemoteSession* session = new RemoteSession(m_nextSessionId++, socket, this);
+        connect( session, SIGNAL(closed(RemoteSession*)), SLOT(onSessionClosed(RemoteSession*)) );
+        m_sessions.append(session);
+
+        emit logMessage(QString("[#%1] Remote Client Connect from:%2").arg(session->id()).arg(session->peer()), LogInfo);
+        notifySessionsChanged();
+    }
+}
+
+void RemoteServer::onSessionClosed(RemoteSession *session)
+{
+    if(!m_sessions.removeOne(session))
+        return;
+
+    emit logMessage(QString("[#%1 %2] ========RemoteServerDisconnect!!========").arg(session->id()).arg(session->peer()), LogError);
+    notifySessionsChanged();
+
+    // kept for a while, the client may only have lost its connection
+    if(!session->token().isEmpty())
+    {
+        RemoteResumeState state = session->resumeState();
+        state.expires = m_clock.elapsed() + RESUME_LIFETIME;
+
+        if(m_parked.size() >= MAX_PARKED_SESSIONS)
+            m_parked.removeFirst();
+
+        m_parked.append(state);
+    }
+
+    // may be inside one of the session's own slots
+    session->deleteLater();
+}
+
+void RemoteServer::notifySessionsChanged()
+{
+    emit sessionsChanged(m_sessions.size(), authenticatedCount());
+}
+
+void RemoteServer::queueRequests()
+{
+    if(m_requestsQueued)
+        return;
+
+    m_requestsQueued = true;
+    QTimer::singleShot(0, this, SLOT(runRequests()));
+}
+
+void RemoteServer::runRequests()
+{
+    m_requestsQueued = false;
+    m_requestTimer.stop();
+
+    qint64 now = m_clock.elapsed();
+    qint64 wait = -1;
+    int idle = 0;
+
+    QElapsedTimer slice;
+    slice.start();
+
+    // one request per session and turn, until a whole round ran nothing;
+    // a session that closes leaves the list on the way
+    while(idle < m_sessions.size())
+    {
+        if(m_nextTurn >= m_sessions.size())
+            m_nextTurn = 0;
+
+        qint64 sessionWait = m_sessions.at(m_nextTurn++)->runNext(now);
+
+        if(sessionWait == 0)
+        {
+            idle = 0;
+
+            // sockets and timers get their turn, then we carry on
+            if(slice.elapsed() >= REQUEST_SLICE)
+            {
+                queueRequests();
+                return;
+            }
+        }
+        else
+        {
+            idle++;
+
+            if(sessionWait > 0)
+                wait = (wait < 0) ? sessionWait : qMin(wait, sessionWait);
+        }
+    }
+
+    // back when the first waiting request has its tokens
+    if(wait > 0)
+        m_requestTimer.start(int(wait));
+}
+
+bool RemoteServer::takeResumeState(const QByteArray &token, RemoteSession *resuming, RemoteResumeState &state)
+{
+    if(token.size() != RemoteProtocol::TOKEN_SIZE)
+        return false;
+
+    // the client reconnected before the server noticed the old connection was gone
+    foreach(RemoteSession* session, m_sessions)
+    {
+        if(session != resuming && session->state() == RemoteSession::Authenticated &&
+           constantTimeEquals(session->token(), token))
+        {
+            state = session->resumeState();
+            session->revokeToken();
+            session->close();
+            return true;
+        }
+    }
+
+    qint64 now = m_clock.elapsed();
+
+    while(!m_parked.isEmpty() && m_parked.first().expires <= now)
+    {
+        m_parked.removeFirst();
+    }
+
+    for(int i = 0; i < m_parked.size(); i++)
+    {
+        if(constantTimeEquals(m_parked.at(i).token, token))
+        {
+            state = m_parked.takeAt(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void RemoteServer::revokeTokens()
+{
+    m_parked.clear();
+
+    foreach(RemoteSession* session, m_sessions)
+    {
+        session->revokeToken();
+    }
+}
@@ -0,0 +1,300 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REMOTESERVER_H
+#define REMOTESERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+#include <QQueue>
+#include <QStringList>
+
+#include "remoteprotocol.h"
+#include "consolebuffer.h"
+#include "filetransfer.h"
+#include "logscanner.h"
+#include "tokenbucket.h"
+
+class RemoteServer;
+class StatusServer;
+
+// What a dropped client gets back when it resumes with its token.
+struct RemoteResumeState
+{
+    RemoteResumeState() :
+        consoleSent(false),
+        consoleSequence(0),
+        subscribed(false),
+        pushSequence(0),
+        expires(0)
+    {
+    }
+
+    QByteArray token;
+    bool consoleSent;
+    quint64 consoleSequence;
+    bool subscribed;
+    quint64 pushSequence;
+    qint64 expires;
+};
+
+// One remote client. Everything that used to be global to the remote
+// tab lives here: authentication, the key timer, the socket's frame
+// decoder, the console cursor and a running log file transfer.
+// Requests wait in a queue until the server gives the session its turn
+// and the session's bucket for that kind of request has tokens.
+class RemoteSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State
+    {
+        Authenticating,
+        Authenticated,
+        Closing
+    };
+
+    // each has its own rate per session
+    enum RequestClass
+    {
+        RequestControl = 0,     // start and stop
+        RequestCommand,         // console commands, per command in a batch
+        RequestLogs,            // console and log file queries
+        RequestFile,            // log file transfers
+        RequestQuery,           // status, capabilities, subscriptions
+        RequestClassCount
+    };
+
+    RemoteSession(int id, QTcpSocket* socket, RemoteServer* server);
+    ~RemoteSession();
+
+    int id() const {return m_id;}
+    State state() const {return m_state;}
+    QString peer() const {return m_peer;}
+
+    void send(quint8 type, const QByteArray& payload, quint32 requestId = 0);
+
+    // sends reason first when given
+    void close(const QByteArray& reason = QByteArray());
+
+    bool isSubscribed() const {return m_subscribed;}
+
+    // empty for clients that did not ask for one, or once it was revoked
+    QByteArray token() const {return m_token;}
+    void revokeToken() {m_token.clear();}
+    RemoteResumeState resumeState() const;
+
+    // sends the lines this session has not seen yet
+    void pushLines();
+
+    // handles the first queued request: 0 when it ran, -1 when nothing
+    // is queued, otherwise milliseconds until its tokens are there
+    qint64 runNext(qint64 now);
+
+signals:
+    void closed(RemoteSession* session);
+
+private slots:
+    void onReadyRead();
+    void onDisconnected();
+    void onAuthTimeout();
+    void onBytesWritten(qint64 bytes);
+    void scanLogs();
+
+private:
+    struct QueuedRequest
+    {
+        RemoteFrame frame;
+        int requestClass;
+        double cost;
+    };
+
+    void readFrames();
+    void scheduleScan();
+    void enqueue(const RemoteFrame& frame);
+    void handleFrame(const RemoteFrame& frame);
+    void dispatch(const RemoteFrame& frame);
+    void reply(quint8 type, const QByteArray& payload);
+    void runBatch(const RemoteFrame& frame);
+    void authenticate(const RemoteFrame& frame);
+    void accept(bool issueToken);
+    void resume(const RemoteFrame& frame);
+    void sendConsole();
+    void sendConsoleUpdate();
+    void subscribe(const RemoteFrame& frame);
+    void negotiate(const RemoteFrame& frame);
+    void write(const QByteArray& frame, const QByteArray& payload = QByteArray());
+    void encode(QByteArray& out, quint8 type, const QByteArray& payload, quint32 requestId = 0);
+    void startFileTransfer(const RemoteFrame& frame);
+    void sendFileChunk();
+    void sendLogList();
+    void startLogGrep(const RemoteFrame& frame);
+    void finishLogGrep(const QString& error);
+    QString logFilePath(const QString& name) const;
+    void log(const QString& text, int kind);
+
+    int m_id;
+    State m_state;
+    QString m_peer;
+    RemoteServer* m_pServer;
+    QTcpSocket* m_pSocket;
+    FrameDecoder m_decoder;
+    FrameDeflater m_deflater;
+    QQueue<QueuedRequest> m_queue;
+    bool m_readPaused;
+    TokenBucket m_buckets[RequestClassCount];
+    quint32 m_requestId;
+    QTimer m_authTimer;
+    QByteArray m_nonce;
+    int m_authAttempts;
+    QByteArray m_token;
+
+    bool m_consoleSent;
+    quint64 m_consoleSequence;
+    bool m_subscribed;
+    quint64 m_pushSequence;
+    bool m_congested;
+
+    FileTransfer m_transfer;
+    quint32 m_transferRequestId;
+
+    LogScanner m_scanner;
+    quint32 m_grepLimit;
+    quint32 m_grepRequestId;
+    // at most one scan step is ever waiting for its turn
+    QTimer m_scanTimer;
+};
+
+// Remote control listener, port 7777 by default. Any number of clients
+// may be connected at once, each gets its own RemoteSession; what they
+// ask of the server is handed on through the signals. Queued requests
+// are run one per session in turn, so a flooding client waits behind
+// everyone else instead of starving them.
+// Runs on its own thread, so the slots are meant to be called through
+// queued connections; the rest is for the sessions on that thread.
+class RemoteServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum LogKind
+    {
+        LogPlain = 0,
+        LogInfo,
+        LogSuccess,
+        LogNotice,
+        LogError
+    };
+
+    explicit RemoteServer(QObject *parent = 0);
+    ~RemoteServer();
+
+    bool isListening() const {return m_server.isListening();}
+
+    QByteArray key() const {return m_key;}
+    bool allowsPlainKey() const {return m_allowPlainKey;}
+    QString serverStatus() const {return m_status;}
+    bool isServerRunning() const {return m_running;}
+    qint64 runningSince() const {return m_runningSince;}
+    qint64 serverProcessId() const {return m_serverProcessId;}
+    QString logsPath() const {return m_logsPath;}
+
+    // the console lines served to clients, in sequence order
+    const ConsoleBuffer& console() const {return m_console;}
+
+    int sessionCount() const {return m_sessions.size();}
+    int authenticatedCount() const;
+
+public slots:
+    void listen(quint16 port);
+    void close();
+    void disconnectAll();
+
+    void setKey(const QByteArray& key);
+
+    // clients that send the key itself rather than answer a challenge
+    void setAllowPlainKey(bool allow) {m_allowPlainKey = allow;}
+    void setServerStatus(const QString& status, bool running);
+    void setServerProcessId(qint64 pid) {m_serverProcessId = pid;}
+    void setLogsPath(const QString& path) {m_logsPath = path;}
+
+    void setConsoleCapacity(int capacity) {m_console.setCapacity(capacity);}
+    void appendLines(const QVector<ConsoleLine>& lines);
+
+    // HTTP status endpoint for monitoring, on this thread as well
+    void listenStatus(quint16 port);
+    void closeStatus();
+
+signals:
+    void logMessage(const QString& text, int kind);
+    void sessionsChanged(int sessions, int authenticated);
+
+    void startRequested();
+    void stopRequested();
+    void commandsReceived(const QStringList& commands);
+
+private slots:
+    void onNewConnection();
+    void onSessionClosed(RemoteSession* session);
+    void notifySessionsChanged();
+    void runRequests();
+
+private:
+    friend class RemoteSession;
+
+    // round robin over the sessions once control is back in the event loop
+    void queueRequests();
+
+    // the state held under token, by a dropped session or one whose
+    // connection is stale; false when the token is unknown or expired
+    bool takeResumeState(const QByteArray& token, RemoteSession* resuming, RemoteResumeState& state);
+    void revokeTokens();
+
+    QTcpServer m_server;
+    QList<RemoteSession*> m_sessions;
+    int m_nextSessionId;
+
+    QElapsedTimer m_clock;
+    QTimer m_requestTimer;
+    bool m_requestsQueued;
+    int m_nextTurn;
+
+    // all sessions together, this is what reaches the server's console
+    TokenBucket m_commandBucket;
+
+    // dropped sessions, oldest first, until their tokens expire
+    QList<RemoteResumeState> m_parked;
+
+    QByteArray m_key;
+    bool m_allowPlainKey;
+    QString m_status;
+    bool m_running;
+    qint64 m_runningSince;
+    qint64 m_serverProcessId;
+    QString m_logsPath;
+    ConsoleBuffer m_console;
+
+    StatusServer* m_pStatus;
+};
+
+#endif // REMOTESERVER_H
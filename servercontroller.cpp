@@ -0,0 +1,368 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "servercontroller.h"
+#include "serverprocess.h"
+#include "consoleingester.h"
+#include "consolestyle.h"
+#include "remoteserver.h"
+
+#include <QSettings>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+
+ServerController::ServerController(QObject *parent) :
+    QObject(parent)
+{
+    m_pServerProcess = 0;
+    m_pServerThread = 0;
+    m_bStartingBat = false;
+    m_pRemoteServer = 0;
+    m_pRemoteThread = 0;
+
+    m_pSettings = ServerSettings::open(this);
+    loadSettings();
+}
+
+ServerController::~ServerController()
+{
+    if(m_pRemoteThread)
+    {
+        m_pRemoteThread->quit();
+        m_pRemoteThread->wait();
+        m_pRemoteThread = 0;
+        m_pRemoteServer = 0;
+    }
+
+    if(m_pServerThread)
+    {
+        m_pServerThread->quit();
+        m_pServerThread->wait();
+        m_pServerThread = 0;
+        m_pServerProcess = 0;
+    }
+}
+
+void ServerController::loadSettings()
+{
+    m_settings.load(*m_pSettings);
+}
+
+void ServerController::saveSettings()
+{
+    m_settings.save(*m_pSettings);
+}
+
+void ServerController::initialize()
+{
+    m_consoleDrainTimer.setSingleShot(true);
+    connect( &m_consoleDrainTimer, SIGNAL(timeout()), SLOT(drainConsole()) );
+    m_sinceConsoleDrain.start();
+
+    qRegisterMetaType<QProcess::ExitStatus>("QProcess::ExitStatus");
+    qRegisterMetaType<QVector<ConsoleLine> >("QVector<ConsoleLine>");
+
+    m_pServerThread = new QThread(this);
+    m_pServerProcess = new ServerProcess;
+    m_pServerProcess->moveToThread(m_pServerThread);
+
+    connect( m_pServerThread, SIGNAL(finished()), m_pServerProcess, SLOT(deleteLater()) );
+    connect( m_pServerProcess, SIGNAL(started()), SLOT(onStarted()) );
+    connect( m_pServerProcess, SIGNAL(startFailed()), SLOT(onStartFailed()) );
+    connect( m_pServerProcess, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onFinished(int,QProcess::ExitStatus)) );
+    connect( m_pServerProcess->ingester(), SIGNAL(linesAvailable()), SLOT(onConsoleLinesAvailable()) );
+
+    m_pServerThread->start();
+
+    // remote clients are served on their own thread, the frontend doesn't hold them up
+    m_pRemoteThread = new QThread(this);
+    m_pRemoteServer = new RemoteServer;
+    m_pRemoteServer->setServerStatus(tr("Minecraft Server: Stopped"), false);
+    m_pRemoteServer->moveToThread(m_pRemoteThread);
+
+    connect( m_pRemoteThread, SIGNAL(finished()), m_pRemoteServer, SLOT(deleteLater()) );
+    connect( m_pRemoteServer, SIGNAL(logMessage(QString,int)), SIGNAL(remoteLogMessage(QString,int)) );
+    connect( m_pRemoteServer, SIGNAL(sessionsChanged(int,int)), SIGNAL(remoteSessionsChanged(int,int)) );
+    connect( m_pRemoteServer, SIGNAL(startRequested()), SLOT(onRemoteStart()) );
+    connect( m_pRemoteServer, SIGNAL(stopRequested()), SLOT(stop()) );
+    connect( m_pRemoteServer, SIGNAL(commandsReceived(QStringList)), SLOT(sendCommands(QStringList)) );
+
+    m_pRemoteThread->start();
+
+    QMetaObject::invokeMethod(m_pRemoteServer, "setConsoleCapacity", Qt::QueuedConnection,
+                              Q_ARG(int, m_settings.consoleScrollback));
+    QMetaObject::invokeMethod(m_pRemoteServer, "setAllowPlainKey", Qt::QueuedConnection,
+                              Q_ARG(bool, m_settings.allowPlainRemoteKey));
+
+    // off unless a port is set, it answers without a key
+    if(m_settings.statusPort > 0)
+    {
+        QMetaObject::invokeMethod(m_pRemoteServer, "listenStatus", Qt::QueuedConnection,
+                                  Q_ARG(quint16, quint16(m_settings.statusPort)));
+    }
+
+    if(m_settings.useConsoleJournal)
+    {
+        // kept next to the settings file
+        m_journalPath = QFileInfo(m_pSettings->fileName()).absolutePath() + QString("/journal");
+
+        // queued ahead of every message, so new lines continue the restored numbering;
+        // the restore runs on the server thread and its lines come with the next drain
+        QMetaObject::invokeMethod(m_pServerProcess, "openJournal", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_journalPath),
+                                  Q_ARG(int, m_settings.journalSegmentSize),
+                                  Q_ARG(int, m_settings.journalSegments),
+                                  Q_ARG(int, m_settings.journalRestoreSegments),
+                                  Q_ARG(int, m_settings.consoleScrollback));
+    }
+}
+
+QProcess::ProcessState ServerController::state() const
+{
+    return m_pServerProcess ? m_pServerProcess->state() : QProcess::NotRunning;
+}
+
+bool ServerController::start()
+{
+    if(m_settings.mcServerPath.isEmpty())
+        return false;
+
+    if(!m_pServerProcess || m_pServerProcess->state() != QProcess::NotRunning)
+        return true;
+
+    emit aboutToStart();
+
+    QString workingDir = ServerSettings::workingDirectory(m_settings.mcServerPath);
+    QString program;
+    QStringList arguments;
+
+    m_bStartingBat = m_settings.command(program, arguments);
+
+    if(m_bStartingBat)
+    {
+        postMessage(tr(">> Starting Java VM (bat) in Working Directory: %1...")
+                    .arg(QDir::toNativeSeparators(workingDir)), ConsoleStyle::Notice);
+        postMessage(tr(">> cmd.exe %1").arg(arguments.join(" ")), ConsoleStyle::Notice);
+    }
+    else
+    {
+        postMessage(tr(">> Starting Java VM in Working Directory: %1...")
+                    .arg(QDir::toNativeSeparators(workingDir)), ConsoleStyle::Notice);
+        postMessage(tr(">> %1 %2").arg(QDir::toNativeSeparators(program))
+                    .arg(arguments.join(" ")), ConsoleStyle::Notice);
+    }
+
+    QMetaObject::invokeMethod(m_pServerProcess, "setMergedChannels", Qt::QueuedConnection,
+                              Q_ARG(bool, m_settings.mergeConsoleChannels));
+
+    // the process is started on its own thread, failures come back through onStartFailed()
+    QMetaObject::invokeMethod(m_pServerProcess, "start", Qt::QueuedConnection,
+                              Q_ARG(QString, program),
+                              Q_ARG(QStringList, arguments),
+                              Q_ARG(QString, workingDir));
+
+    return true;
+}
+
+void ServerController::stop()
+{
+    if(state() == QProcess::Running)
+    {
+        postMessage(tr(">> Stopping Minecraft Server..."), ConsoleStyle::Notice);
+
+        writeToServer(QByteArray("stop\n"));
+    }
+}
+
+void ServerController::sendCommands(const QStringList &commands)
+{
+    if(state() != QProcess::Running)
+        return;
+
+    QByteArray data;
+
+    foreach(const QString& command, commands)
+    {
+        postMessage(QString("<< ") + command, ConsoleStyle::Command);
+
+        if(command.trimmed() == "stop")
+        {
+            postMessage(tr(">> Stopping Minecraft Server..."), ConsoleStyle::Notice);
+        }
+
+        data += (command + QString("\n")).toLatin1();
+    }
+
+    writeToServer(data);
+}
+
+void ServerController::waitForFinished()
+{
+    if(state() != QProcess::NotRunning)
+        QMetaObject::invokeMethod(m_pServerProcess, "waitForFinished", Qt::BlockingQueuedConnection);
+}
+
+void ServerController::writeToServer(const QByteArray &data)
+{
+    // written on the server thread, never waits here
+    QMetaObject::invokeMethod(m_pServerProcess, "write", Qt::QueuedConnection,
+                              Q_ARG(QByteArray, data));
+}
+
+void ServerController::postMessage(const QString &text, int style)
+{
+    if(!m_pServerProcess)
+        return;
+
+    // shows up with the next drain
+    QMetaObject::invokeMethod(m_pServerProcess, "postMessage", Qt::QueuedConnection,
+                              Q_ARG(QString, text), Q_ARG(int, style));
+}
+
+void ServerController::onStarted()
+{
+    postMessage(tr(">> Starting Minecraft Server..."), ConsoleStyle::Notice);
+
+    QMetaObject::invokeMethod(m_pRemoteServer, "setServerProcessId", Qt::QueuedConnection,
+                              Q_ARG(qint64, m_pServerProcess->processId()));
+    QMetaObject::invokeMethod(m_pRemoteServer, "setServerStatus", Qt::QueuedConnection,
+                              Q_ARG(QString, tr("Minecraft Server: Running")), Q_ARG(bool, true));
+
+    emit started();
+}
+
+void ServerController::onStartFailed()
+{
+    if(m_bStartingBat)
+    {
+        postMessage(tr(">> Unable to start bat."), ConsoleStyle::Failure);
+    }
+    else
+    {
+        postMessage(tr(">> Unable to start Java VM."), ConsoleStyle::Failure);
+    }
+
+    emit startFailed();
+}
+
+void ServerController::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if((exitStatus == QProcess::NormalExit) && (exitCode ==  0))
+    {
+        postMessage(tr(">> Minecraft Server stopped normally with exit code: %1").arg(exitCode), ConsoleStyle::Notice);
+    }
+    else if((exitStatus == QProcess::NormalExit) && (exitCode ==  1))
+    {
+        postMessage(tr(">> Minecraft Server killed and exited with exit code: %1").arg(exitCode), ConsoleStyle::Failure);
+    }
+    else if(exitStatus == QProcess::CrashExit)
+    {
+        postMessage(tr(">> Minecraft Server crashed!"), ConsoleStyle::Failure);
+    }
+
+    QMetaObject::invokeMethod(m_pRemoteServer, "setServerProcessId", Qt::QueuedConnection,
+                              Q_ARG(qint64, qint64(0)));
+    QMetaObject::invokeMethod(m_pRemoteServer, "setServerStatus", Qt::QueuedConnection,
+                              Q_ARG(QString, tr("Minecraft Server: Stopped")), Q_ARG(bool, false));
+
+    emit finished(exitCode, exitStatus);
+}
+
+void ServerController::onRemoteStart()
+{
+    if(state() != QProcess::NotRunning)
+        return;
+
+    if(!start())
+        postMessage(tr(">> No Minecraft Server File available!"), ConsoleStyle::Failure);
+}
+
+void ServerController::onConsoleLinesAvailable()
+{
+    if(m_consoleDrainTimer.isActive())
+        return;
+
+    // at most consoleFlushRate drains per second
+    int interval = 1000 / qBound(1, m_settings.consoleFlushRate, 1000);
+    qint64 elapsed = m_sinceConsoleDrain.elapsed();
+
+    m_consoleDrainTimer.start(elapsed >= interval ? 0 : int(interval - elapsed));
+}
+
+void ServerController::drainConsole()
+{
+    if(!m_pServerProcess)
+        return;
+
+    m_consoleDrainTimer.stop();
+    m_sinceConsoleDrain.restart();
+
+    QVector<ConsoleLine> lines;
+    int maxLines = qMax(1, m_settings.consoleScrollback);
+
+    if(m_pServerProcess->ingester()->drain(lines, maxLines) == maxLines)
+    {
+        // more waiting, pick up the rest with the next frame
+        onConsoleLinesAvailable();
+    }
+
+    if(!lines.isEmpty())
+        appendConsoleLines(lines);
+}
+
+void ServerController::appendConsoleLines(const QVector<ConsoleLine> &lines)
+{
+    QMetaObject::invokeMethod(m_pRemoteServer, "appendLines", Qt::QueuedConnection,
+                              Q_ARG(QVector<ConsoleLine>, lines));
+
+    emit consoleLines(lines);
+}
+
+void ServerController::flushJournal()
+{
+    if(m_pServerProcess && !m_journalPath.isEmpty())
+        QMetaObject::invokeMethod(m_pServerProcess, "flushJournal", Qt::BlockingQueuedConnection);
+}
+
+void ServerController::listenRemote()
+{
+    updateLogsPath();
+    QMetaObject::invokeMethod(m_pRemoteServer, "listen", Qt::QueuedConnection,
+                              Q_ARG(quint16, quint16(m_settings.remotePort)));
+}
+
+void ServerController::closeRemote()
+{
+    // stops listening and drops every client
+    QMetaObject::invokeMethod(m_pRemoteServer, "close", Qt::QueuedConnection);
+}
+
+void ServerController::refreshKey()
+{
+    m_key = connectionKey(QDateTime::currentDateTime());
+    QMetaObject::invokeMethod(m_pRemoteServer, "setKey", Qt::QueuedConnection,
+                              Q_ARG(QByteArray, m_key));
+
+    emit keyChanged(m_key);
+}
+
+void ServerController::updateLogsPath()
+{
+    QMetaObject::invokeMethod(m_pRemoteServer, "setLogsPath", Qt::QueuedConnection,
+                              Q_ARG(QString, ServerSettings::logsPath(m_settings.mcServerPath)));
+}
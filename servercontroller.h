@@ -0,0 +1,123 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVERCONTROLLER_H
+#define SERVERCONTROLLER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include "consolebuffer.h"
+#include "serversettings.h"
+
+class QSettings;
+class ServerProcess;
+class RemoteServer;
+
+// Runs the Minecraft server without any widgets: settings, the server
+// process and its console pipeline, the journal, the remote and status
+// servers. The window and the headless daemon are frontends on top of
+// it, they only show what it emits and call its slots. Lives on the
+// thread of the application object, QCoreApplication is enough.
+class ServerController : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ServerController(QObject *parent = 0);
+    ~ServerController();
+
+    // loaded when constructed, changes take effect with the next start
+    ServerSettings& settings() {return m_settings;}
+    void loadSettings();
+    void saveSettings();
+
+    // starts the threads and restores the journal, connect first
+    void initialize();
+
+    QProcess::ProcessState state() const;
+    ServerProcess* serverProcess() const {return m_pServerProcess;}
+
+    // empty without a journal
+    QString journalPath() const {return m_journalPath;}
+
+    QByteArray key() const {return m_key;}
+
+public slots:
+    // false without a server file
+    bool start();
+    void stop();
+    void sendCommands(const QStringList& commands);
+    void waitForFinished();
+
+    // numbered and journaled in line with the server output
+    void postMessage(const QString& text, int style);
+
+    void drainConsole();
+    void flushJournal();
+
+    void listenRemote();
+    void closeRemote();
+    void refreshKey();
+    // the logs served to remote clients follow the server path
+    void updateLogsPath();
+
+signals:
+    // directly before starting, for frontends with unsaved edits
+    void aboutToStart();
+    void started();
+    void startFailed();
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+    void consoleLines(const QVector<ConsoleLine>& lines);
+    void keyChanged(const QByteArray& key);
+
+    void remoteLogMessage(const QString& text, int kind);
+    void remoteSessionsChanged(int sessions, int authenticated);
+
+private slots:
+    void onStarted();
+    void onStartFailed();
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onConsoleLinesAvailable();
+    void onRemoteStart();
+
+private:
+    void appendConsoleLines(const QVector<ConsoleLine>& lines);
+    void writeToServer(const QByteArray& data);
+
+    QSettings* m_pSettings;
+    ServerSettings m_settings;
+
+    ServerProcess* m_pServerProcess;
+    QThread* m_pServerThread;
+    bool m_bStartingBat;
+    QString m_journalPath;
+
+    QTimer m_consoleDrainTimer;
+    QElapsedTimer m_sinceConsoleDrain;
+
+    RemoteServer* m_pRemoteServer;
+    QThread* m_pRemoteThread;
+    QByteArray m_key;
+};
+
+#endif // SERVERCONTROLLER_H
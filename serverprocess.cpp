@@ -0,0 +1,140 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serverprocess.h"
+#include "consoleingester.h"
+#include "consolejournal.h"
+#include "consolestyle.h"
+
+ServerProcess::ServerProcess(QObject *parent) :
+    QObject(parent)
+{
+    m_state.storeRelease(QProcess::NotRunning);
+    m_processId.storeRelease(0);
+    m_mergedChannels = false;
+
+    m_pProcess = new QProcess(this);
+    m_pIngester = new ConsoleIngester(this);
+    m_pJournal = new ConsoleJournal(this);
+
+    connect( m_pProcess, SIGNAL(started()), SLOT(onStarted()) );
+    connect( m_pProcess, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(onFinished(int,QProcess::ExitStatus)) );
+    connect( m_pProcess, SIGNAL(readyReadStandardOutput()), SLOT(onStandardOutput()) );
+    connect( m_pProcess, SIGNAL(readyReadStandardError()), SLOT(onStandardError()) );
+}
+
+void ServerProcess::start(const QString &program, const QStringList &arguments, const QString &workingDirectory)
+{
+    if(m_pProcess->state() != QProcess::NotRunning)
+        return;
+
+    m_state.storeRelease(QProcess::Starting);
+
+    // merged, the server's own write order is kept but stderr is no longer told apart
+    m_pProcess->setProcessChannelMode(m_mergedChannels ? QProcess::MergedChannels : QProcess::SeparateChannels);
+    m_pProcess->setWorkingDirectory(workingDirectory);
+    m_pProcess->start(program, arguments, QIODevice::ReadWrite | QIODevice::Unbuffered);
+
+    if(!m_pProcess->waitForStarted())
+    {
+        m_state.storeRelease(QProcess::NotRunning);
+        emit startFailed();
+    }
+}
+
+void ServerProcess::write(const QByteArray &data)
+{
+    if(m_pProcess->state() == QProcess::Running && m_pProcess->isWritable())
+    {
+        m_pProcess->write(data);
+    }
+}
+
+void ServerProcess::waitForFinished()
+{
+    if(m_pProcess->state() != QProcess::NotRunning)
+    {
+        m_pProcess->waitForFinished();
+    }
+}
+
+void ServerProcess::openJournal(const QString &directory, int segmentSizeMB, int maxSegments,
+                                int restoreSegments, int restoreLines)
+{
+    if(!m_pJournal->open(directory, qint64(segmentSizeMB) * 1024 * 1024, maxSegments))
+        return;
+
+    // the console continues the journal's numbering
+    m_pIngester->setNextSequence(m_pJournal->nextSequence());
+    m_pIngester->setJournal(m_pJournal);
+
+    // read here rather than on startup, a large journal doesn't delay it
+    QVector<ConsoleLine> restored = ConsoleJournal::restore(directory, restoreSegments, restoreLines);
+    if(restored.isEmpty())
+        return;
+
+    // the console numbers lines by position, the restored ones have to
+    // lead straight into the next sequence
+    if(restored.last().sequence + 1 != m_pJournal->nextSequence())
+    {
+        qWarning("Console journal restore ends at %llu, the journal continues at %llu, not restored",
+                 static_cast<unsigned long long>(restored.last().sequence),
+                 static_cast<unsigned long long>(m_pJournal->nextSequence()));
+        return;
+    }
+
+    m_pIngester->restore(restored);
+
+    // numbered and journaled after the restored lines
+    m_pIngester->post(tr(">> Restored %1 lines from the console journal").arg(restored.size()), ConsoleStyle::Notice);
+}
+
+void ServerProcess::postMessage(const QString &text, int style)
+{
+    m_pIngester->post(text, style);
+}
+
+void ServerProcess::flushJournal()
+{
+    m_pJournal->flush();
+}
+
+void ServerProcess::onStarted()
+{
+    m_processId.storeRelease(m_pProcess->processId());
+    m_state.storeRelease(QProcess::Running);
+    emit started();
+}
+
+void ServerProcess::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    m_pIngester->finish();
+
+    m_state.storeRelease(QProcess::NotRunning);
+    m_processId.storeRelease(0);
+    emit finished(exitCode, exitStatus);
+}
+
+void ServerProcess::onStandardOutput()
+{
+    m_pIngester->feed(ConsoleIngester::StandardOutput, m_pProcess->readAllStandardOutput());
+}
+
+void ServerProcess::onStandardError()
+{
+    m_pIngester->feed(ConsoleIngester::StandardError, m_pProcess->readAllStandardError());
+}
@@ -0,0 +1,80 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVERPROCESS_H
+#define SERVERPROCESS_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QAtomicInt>
+
+class ConsoleIngester;
+class ConsoleJournal;
+
+// Owns the Minecraft server process. Meant to be moved to its own
+// thread, so reading the server's console never waits for the GUI.
+// The slots are called through queued connections, state() and
+// ingester() may be used from any thread.
+class ServerProcess : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ServerProcess(QObject *parent = 0);
+
+    QProcess::ProcessState state() const {return QProcess::ProcessState(m_state.loadAcquire());}
+
+    // of the running server, 0 otherwise
+    qint64 processId() const {return m_processId.loadAcquire();}
+
+    ConsoleIngester* ingester() const {return m_pIngester;}
+
+public slots:
+    void start(const QString& program, const QStringList& arguments, const QString& workingDirectory);
+    void setMergedChannels(bool merged) {m_mergedChannels = merged;}
+    void write(const QByteArray& data);
+    void waitForFinished();
+
+    // the newest lines of the last restoreSegments segments go to the
+    // console first
+    void openJournal(const QString& directory, int segmentSizeMB, int maxSegments,
+                     int restoreSegments, int restoreLines);
+    void postMessage(const QString& text, int style);
+    void flushJournal();
+
+signals:
+    void started();
+    void startFailed();
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private slots:
+    void onStarted();
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onStandardOutput();
+    void onStandardError();
+
+private:
+    QProcess* m_pProcess;
+    ConsoleIngester* m_pIngester;
+    ConsoleJournal* m_pJournal;
+    QAtomicInt m_state;
+    QAtomicInteger<qint64> m_processId;
+    bool m_mergedChannels;
+};
+
+#endif // SERVERPROCESS_H
@@ -0,0 +1,138 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serversettings.h"
+
+#include <QSettings>
+#include <QFileInfo>
+
+ServerSettings::ServerSettings()
+{
+    useCustomJavaPath = false;
+    xms = 512;
+    xmx = 512;
+    consoleScrollback = 50000;
+    consoleFlushRate = 20;
+    useConsoleJournal = true;
+    mergeConsoleChannels = false;
+    journalSegmentSize = 16;
+    journalSegments = 32;
+    journalRestoreSegments = 4;
+    remotePort = 7777;
+    allowPlainRemoteKey = true;
+    statusPort = 0;
+}
+
+void ServerSettings::load(QSettings &settings)
+{
+    useCustomJavaPath = (settings.value("Settings/UseCustomJavaPath", "no").toString() == "yes");
+    customJavaPath = settings.value("Settings/CustomJavaPath", "").toString();
+    mcServerPath = settings.value("Settings/MinecraftServerPath", "").toString();
+    xms = settings.value("Settings/Xms", "512").toInt();
+    xmx = settings.value("Settings/Xmx", "512").toInt();
+    additionalParameters = settings.value("Settings/AdditionalParameters", "").toString();
+    consoleScrollback = settings.value("Settings/ConsoleScrollback", "50000").toInt();
+    consoleFlushRate = settings.value("Settings/ConsoleFlushRate", "20").toInt();
+    useConsoleJournal = (settings.value("Settings/UseConsoleJournal", "yes").toString() == "yes");
+    mergeConsoleChannels = (settings.value("Settings/MergeConsoleChannels", "no").toString() == "yes");
+    journalSegmentSize = settings.value("Settings/JournalSegmentSize", "16").toInt();
+    journalSegments = settings.value("Settings/JournalSegments", "32").toInt();
+    journalRestoreSegments = settings.value("Settings/JournalRestoreSegments", "4").toInt();
+    remotePort = settings.value("Settings/RemotePort", "7777").toInt();
+    allowPlainRemoteKey = (settings.value("Settings/AllowPlainRemoteKey", "yes").toString() == "yes");
+    statusPort = settings.value("Settings/StatusPort", "0").toInt();
+}
+
+void ServerSettings::save(QSettings &settings) const
+{
+    settings.setValue("Settings/UseCustomJavaPath", useCustomJavaPath ? "yes" : "no");
+    settings.setValue("Settings/CustomJavaPath", customJavaPath);
+    settings.setValue("Settings/MinecraftServerPath", mcServerPath);
+    settings.setValue("Settings/Xms", xms);
+    settings.setValue("Settings/Xmx", xmx);
+    settings.setValue("Settings/AdditionalParameters", additionalParameters);
+    settings.setValue("Settings/ConsoleScrollback", consoleScrollback);
+    settings.setValue("Settings/ConsoleFlushRate", consoleFlushRate);
+    settings.setValue("Settings/UseConsoleJournal", useConsoleJournal ? "yes" : "no");
+    settings.setValue("Settings/MergeConsoleChannels", mergeConsoleChannels ? "yes" : "no");
+    settings.setValue("Settings/JournalSegmentSize", journalSegmentSize);
+    settings.setValue("Settings/JournalSegments", journalSegments);
+    settings.setValue("Settings/JournalRestoreSegments", journalRestoreSegments);
+    settings.setValue("Settings/RemotePort", remotePort);
+    settings.setValue("Settings/AllowPlainRemoteKey", allowPlainRemoteKey ? "yes" : "no");
+    settings.setValue("Settings/StatusPort", statusPort);
+}
+
+QSettings *ServerSettings::open(QObject *parent)
+{
+    return new QSettings(QSettings::IniFormat, QSettings::UserScope, "Qt Minecraft Server", "qtmcserver", parent);
+}
+
+bool ServerSettings::command(QString &program, QStringList &arguments) const
+{
+    QString mcServerFile = QFileInfo(mcServerPath).fileName();
+
+    arguments.clear();
+
+    if(mcServerFile.split('.').last() == "bat")
+    {
+        program = "cmd.exe";
+        arguments.append("/c");
+        arguments.append(mcServerFile);
+        return true;
+    }
+
+    if(xms > 0)
+        arguments.append(QString("-Xms%1M").arg(QString::number(xms)));
+
+    if(xmx > 0)
+        arguments.append(QString("-Xmx%1M").arg(QString::number(xmx)));
+
+    arguments.append("-jar");
+    arguments.append(mcServerFile);
+    arguments.append("nogui");
+
+    if(!additionalParameters.isEmpty())
+        arguments.append(additionalParameters);
+
+    program = useCustomJavaPath ? customJavaPath : QString("java");
+    return false;
+}
+
+QString ServerSettings::workingDirectory(const QString &mcServerPath)
+{
+    if(mcServerPath.isEmpty())
+        return QString();
+
+    return QFileInfo(mcServerPath).absolutePath();
+}
+
+QString ServerSettings::propertiesPath(const QString &mcServerPath)
+{
+    if(mcServerPath.isEmpty())
+        return QString();
+
+    return workingDirectory(mcServerPath) + QString("/server.properties");
+}
+
+QString ServerSettings::logsPath(const QString &mcServerPath)
+{
+    if(mcServerPath.isEmpty())
+        return QString();
+
+    return workingDirectory(mcServerPath) + QString("/logs/latest.log");
+}
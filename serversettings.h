@@ -0,0 +1,65 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVERSETTINGS_H
+#define SERVERSETTINGS_H
+
+#include <QString>
+#include <QStringList>
+
+class QSettings;
+
+// Everything kept in the [Settings] section of the settings file, shared
+// by the window and the headless daemon.
+struct ServerSettings
+{
+    ServerSettings();
+
+    void load(QSettings& settings);
+    void save(QSettings& settings) const;
+
+    // the settings file both frontends use
+    static QSettings* open(QObject* parent);
+
+    // program and arguments that start the server, true for a .bat file
+    bool command(QString& program, QStringList& arguments) const;
+
+    static QString workingDirectory(const QString& mcServerPath);
+    static QString propertiesPath(const QString& mcServerPath);
+    static QString logsPath(const QString& mcServerPath);
+
+    bool useCustomJavaPath;
+    QString customJavaPath;
+    QString mcServerPath;
+    int xms;
+    int xmx;
+    QString additionalParameters;
+
+    int consoleScrollback;
+    int consoleFlushRate;
+    bool useConsoleJournal;
+    bool mergeConsoleChannels;
+    int journalSegmentSize;
+    int journalSegments;
+    int journalRestoreSegments;
+
+    int remotePort;
+    bool allowPlainRemoteKey;   // deprecated Key authentication, the key goes in the clear
+    int statusPort;
+};
+
+#endif // SERVERSETTINGS_H
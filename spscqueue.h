@@ -0,0 +1,87 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QAtomicInteger>
+
+// Bounded lock-free queue for exactly one producer thread and one
+// consumer thread. push() never blocks, it fails when the queue is full.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(int capacity)
+    {
+        quint32 size = 2;
+        while(size < quint32(capacity))
+            size <<= 1;
+
+        m_items = new T[size];
+        m_mask = size - 1;
+    }
+
+    ~SpscQueue()
+    {
+        delete [] m_items;
+    }
+
+    int capacity() const {return int(m_mask + 1);}
+
+    // producer side
+    bool push(const T& value)
+    {
+        quint32 tail = m_tail.loadRelaxed();
+
+        if(tail - m_head.loadAcquire() > m_mask)
+            return false;
+
+        m_items[tail & m_mask] = value;
+        m_tail.storeRelease(tail + 1);
+        return true;
+    }
+
+    // consumer side
+    bool pop(T& value)
+    {
+        quint32 head = m_head.loadRelaxed();
+
+        if(head == m_tail.loadAcquire())
+            return false;
+
+        value = m_items[head & m_mask];
+        m_items[head & m_mask] = T();
+        m_head.storeRelease(head + 1);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.loadAcquire() == m_tail.loadAcquire();
+    }
+
+private:
+    Q_DISABLE_COPY(SpscQueue)
+
+    T* m_items;
+    quint32 m_mask;
+    QAtomicInteger<quint32> m_head;
+    QAtomicInteger<quint32> m_tail;
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,371 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "statusserver.h"
+#include "remoteserver.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+// uptime and memory are sampled this often, polls in between get a 304
+#define STATS_INTERVAL 10000
+
+// a request head larger than this is refused
+#define MAX_HEAD_SIZE 8192
+
+#define MAX_CONNECTIONS 256
+
+// keep-alive connections without a request for this long are closed
+#define IDLE_TIMEOUT 60000
+
+// resident memory of a process in KB, -1 where it is not known
+static qint64 residentKB(qint64 pid)
+{
+#if defined(Q_OS_WIN)
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(pid));
+    if(!process)
+        return -1;
+
+    PROCESS_MEMORY_COUNTERS counters;
+    qint64 size = -1;
+    if(GetProcessMemoryInfo(process, &counters, sizeof(counters)))
+        size = qint64(counters.WorkingSetSize / 1024);
+
+    CloseHandle(process);
+    return size;
+#elif defined(Q_OS_LINUX)
+    QFile file(QString("/proc/%1/status").arg(pid));
+    if(!file.open(QIODevice::ReadOnly))
+        return -1;
+
+    // "VmRSS:     12345 kB"
+    foreach(const QByteArray& line, file.readAll().split('\n'))
+    {
+        if(line.startsWith("VmRSS:"))
+            return line.mid(6).simplified().split(' ').value(0).toLongLong();
+    }
+
+    return -1;
+#else
+    Q_UNUSED(pid);
+    return -1;
+#endif
+}
+
+StatusServer::StatusServer(RemoteServer *remote) :
+    QObject(remote),
+    m_server(this)
+{
+    m_pRemote = remote;
+    m_running = false;
+    m_firstSequence = 0;
+    m_sequence = 0;
+    m_sessions = 0;
+    m_authenticated = 0;
+    m_statsTick = -1;
+    m_selfKB = -1;
+    m_serverKB = -1;
+    m_version = 0;
+
+    // tags handed out by an earlier run never match
+    m_instance = QByteArray::number(QDateTime::currentMSecsSinceEpoch(), 36);
+
+    m_clock.start();
+    m_idleTimer.setInterval(IDLE_TIMEOUT / 4);
+
+    connect( &m_server, SIGNAL(newConnection()), SLOT(onNewConnection()) );
+    connect( &m_idleTimer, SIGNAL(timeout()), SLOT(closeIdle()) );
+}
+
+StatusServer::~StatusServer()
+{
+    m_server.close();
+}
+
+bool StatusServer::listen(quint16 port)
+{
+    if(m_server.isListening())
+        return true;
+
+    if(!m_server.listen(QHostAddress::AnyIPv4, port))
+        return false;
+
+    m_idleTimer.start();
+    return true;
+}
+
+void StatusServer::close()
+{
+    m_server.close();
+    m_idleTimer.stop();
+
+    foreach(QTcpSocket* socket, m_connections.keys())
+    {
+        disconnect( socket, 0, this, 0 );
+        socket->abort();
+        socket->deleteLater();
+    }
+
+    m_connections.clear();
+}
+
+void StatusServer::onNewConnection()
+{
+    while(m_server.hasPendingConnections())
+    {
+        QTcpSocket* socket = m_server.nextPendingConnection();
+
+        if(m_connections.size() >= MAX_CONNECTIONS)
+        {
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+
+        Connection connection;
+        connection.lastActive = m_clock.elapsed();
+        m_connections.insert(socket, connection);
+
+        connect( socket, SIGNAL(readyRead()), SLOT(onReadyRead()) );
+        connect( socket, SIGNAL(disconnected()), SLOT(onDisconnected()) );
+    }
+}
+
+void StatusServer::onReadyRead()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+
+    QHash<QTcpSocket*, Connection>::iterator connection = m_connections.find(socket);
+    if(connection == m_connections.end())
+        return;
+
+    connection->buffer.append(socket->readAll());
+    connection->lastActive = m_clock.elapsed();
+
+    // pipelined requests are answered in order
+    int end;
+    while((end = connection->buffer.indexOf("\r\n\r\n")) >= 0)
+    {
+        QByteArray head = connection->buffer.left(end);
+        connection->buffer.remove(0, end + 4);
+
+        if(!handleRequest(socket, head))
+        {
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+
+    if(connection->buffer.size() > MAX_HEAD_SIZE)
+    {
+        socket->write(response("431 Request Header Fields Too Large", QByteArray(), false, false));
+        socket->disconnectFromHost();
+    }
+}
+
+void StatusServer::onDisconnected()
+{
+    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
+
+    m_connections.remove(socket);
+    socket->deleteLater();
+}
+
+void StatusServer::closeIdle()
+{
+    qint64 now = m_clock.elapsed();
+    QList<QTcpSocket*> idle;
+
+    QHash<QTcpSocket*, Connection>::const_iterator connection;
+    for(connection = m_connections.constBegin(); connection != m_connections.constEnd(); ++connection)
+    {
+        if(now - connection->lastActive > IDLE_TIMEOUT)
+            idle.append(connection.key());
+    }
+
+    // may leave the table right away
+    foreach(QTcpSocket* socket, idle)
+    {
+        socket->disconnectFromHost();
+    }
+}
+
+bool StatusServer::handleRequest(QTcpSocket *socket, const QByteArray &head)
+{
+    QList<QByteArray> lines = head.split('\n');
+    QList<QByteArray> request = lines.value(0).trimmed().split(' ');
+
+    if(request.size() != 3 || !request.at(2).startsWith("HTTP/1."))
+    {
+        socket->write(response("400 Bad Request", QByteArray(), false, false));
+        return false;
+    }
+
+    const QByteArray& method = request.at(0);
+    QByteArray path = request.at(1);
+    bool keepAlive = (request.at(2) == "HTTP/1.1");
+    QByteArray ifNoneMatch;
+
+    for(int i = 1; i < lines.size(); i++)
+    {
+        const QByteArray& line = lines.at(i);
+        int colon = line.indexOf(':');
+        if(colon < 0)
+            continue;
+
+        QByteArray name = line.left(colon).trimmed().toLower();
+        QByteArray value = line.mid(colon + 1).trimmed();
+
+        if(name == "if-none-match")
+            ifNoneMatch = value;
+        else if(name == "connection" && value.toLower() == "close")
+            keepAlive = false;
+    }
+
+    int query = path.indexOf('?');
+    if(query >= 0)
+        path.truncate(query);
+
+    bool withBody = (method == "GET");
+
+    // nothing here takes a request body, so the connection cannot be reused
+    if(!withBody && method != "HEAD")
+    {
+        socket->write(response("405 Method Not Allowed", QByteArray(), false, false));
+        return false;
+    }
+
+    if(path != "/status")
+    {
+        socket->write(response("404 Not Found", QByteArray(), keepAlive, false));
+        return keepAlive;
+    }
+
+    refresh();
+
+    bool matched = false;
+    foreach(const QByteArray& tag, ifNoneMatch.split(','))
+    {
+        QByteArray trimmed = tag.trimmed();
+        if(trimmed == "*" || trimmed == m_etag || trimmed == "W/" + m_etag)
+            matched = true;
+    }
+
+    // the usual answers are ready made
+    if(matched)
+        socket->write(keepAlive ? m_notModifiedResponse : response("304 Not Modified", QByteArray(), false, false));
+    else if(keepAlive && withBody)
+        socket->write(m_okResponse);
+    else
+        socket->write(response("200 OK", m_body, keepAlive, withBody));
+
+    return keepAlive;
+}
+
+QByteArray StatusServer::response(const QByteArray &status, const QByteArray &body, bool keepAlive, bool withBody) const
+{
+    bool document = status.startsWith("200") || status.startsWith("304");
+
+    QByteArray out = "HTTP/1.1 " + status + "\r\n";
+
+    if(document)
+        out += "ETag: " + m_etag + "\r\nCache-Control: no-cache\r\n";
+
+    if(!body.isEmpty())
+        out += "Content-Type: application/json\r\n";
+
+    if(!status.startsWith("304"))
+        out += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+
+    if(!keepAlive)
+        out += "Connection: close\r\n";
+
+    out += "\r\n";
+
+    if(withBody)
+        out += body;
+
+    return out;
+}
+
+void StatusServer::refresh()
+{
+    const ConsoleBuffer& console = m_pRemote->console();
+    qint64 tick = m_clock.elapsed() / STATS_INTERVAL;
+
+    if(!m_body.isEmpty() && tick == m_statsTick &&
+       m_running == m_pRemote->isServerRunning() &&
+       m_status == m_pRemote->serverStatus() &&
+       m_sessions == m_pRemote->sessionCount() &&
+       m_authenticated == m_pRemote->authenticatedCount())
+        return;
+
+    // memory and the console position are read once per interval, not on
+    // every change, a busy console would otherwise never answer 304
+    if(tick != m_statsTick)
+    {
+        m_statsTick = tick;
+        m_firstSequence = console.firstSequence();
+        m_sequence = console.nextSequence();
+        m_selfKB = residentKB(QCoreApplication::applicationPid());
+        m_serverKB = (m_pRemote->serverProcessId() > 0) ? residentKB(m_pRemote->serverProcessId()) : -1;
+    }
+
+    m_running = m_pRemote->isServerRunning();
+    m_status = m_pRemote->serverStatus();
+    m_sessions = m_pRemote->sessionCount();
+    m_authenticated = m_pRemote->authenticatedCount();
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 since = m_pRemote->runningSince();
+
+    QJsonObject consoleObject;
+    consoleObject["firstSequence"] = double(m_firstSequence);
+    consoleObject["nextSequence"] = double(m_sequence);
+
+    QJsonObject remoteObject;
+    remoteObject["sessions"] = m_sessions;
+    remoteObject["verified"] = m_authenticated;
+
+    QJsonObject memoryObject;
+    memoryObject["qtmcserverKB"] = double(m_selfKB);
+    memoryObject["serverKB"] = double(m_serverKB);
+
+    QJsonObject status;
+    status["running"] = m_running;
+    status["status"] = m_status;
+    status["startedAt"] = m_running ? QJsonValue(double(since)) : QJsonValue();
+    status["uptime"] = m_running ? double((now - since) / 1000) : 0.0;
+    status["console"] = consoleObject;
+    status["remote"] = remoteObject;
+    status["memory"] = memoryObject;
+    status["generated"] = double(now);
+
+    m_body = QJsonDocument(status).toJson(QJsonDocument::Compact);
+    m_etag = "\"" + m_instance + "-" + QByteArray::number(++m_version) + "\"";
+
+    m_okResponse = response("200 OK", m_body, true, true);
+    m_notModifiedResponse = response("304 Not Modified", QByteArray(), true, false);
+}
@@ -0,0 +1,99 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATUSSERVER_H
+#define STATUSSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+
+class RemoteServer;
+
+// Read-only HTTP endpoint for monitoring. GET /status answers a small
+// JSON document: server state, uptime, console sequence number, remote
+// sessions and memory use. The document is only rebuilt when something
+// in it changed, and its ETag lets a poller that sends If-None-Match get
+// a bodiless 304 while nothing did.
+// Lives on the remote server's thread and reads its state directly.
+class StatusServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StatusServer(RemoteServer* remote);
+    ~StatusServer();
+
+    bool isListening() const {return m_server.isListening();}
+
+    bool listen(quint16 port);
+    void close();
+
+    QString errorString() const {return m_server.errorString();}
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+    void closeIdle();
+
+private:
+    struct Connection
+    {
+        Connection() :
+            lastActive(0)
+        {
+        }
+
+        QByteArray buffer;
+        qint64 lastActive;
+    };
+
+    // false when the connection is to be closed
+    bool handleRequest(QTcpSocket* socket, const QByteArray& head);
+    QByteArray response(const QByteArray& status, const QByteArray& body, bool keepAlive, bool withBody) const;
+    void refresh();
+
+    RemoteServer* m_pRemote;
+    QTcpServer m_server;
+    QHash<QTcpSocket*, Connection> m_connections;
+    QElapsedTimer m_clock;
+    QTimer m_idleTimer;
+
+    // what the current document was built from
+    QString m_status;
+    bool m_running;
+    quint64 m_firstSequence;
+    quint64 m_sequence;
+    int m_sessions;
+    int m_authenticated;
+    qint64 m_statsTick;
+    qint64 m_selfKB;
+    qint64 m_serverKB;
+
+    quint64 m_version;
+    QByteArray m_instance;
+    QByteArray m_etag;
+    QByteArray m_body;
+    QByteArray m_okResponse;
+    QByteArray m_notModifiedResponse;
+};
+
+#endif // STATUSSERVER_H
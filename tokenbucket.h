@@ -0,0 +1,87 @@
+/*
+ * Qt Minecraft Server
+ * Copyleft 2013
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <QtGlobal>
+
+// Refills at a rate of tokens per second up to the burst size. A cost
+// above the burst goes through once the bucket is full and leaves it in
+// debt, so a large request is paid off over time instead of refused.
+// The debt is bounded by one burst, so a single caller can't lock up a
+// shared bucket for longer than two bursts take to refill.
+// Times are milliseconds on any steady clock; a rate of 0 means no limit.
+class TokenBucket
+{
+public:
+    TokenBucket() :
+        m_rate(0),
+        m_burst(0),
+        m_tokens(0),
+        m_updated(0)
+    {
+    }
+
+    void setRate(double rate, double burst)
+    {
+        m_rate = rate;
+        m_burst = burst;
+        m_tokens = burst;
+    }
+
+    bool isLimited() const {return m_rate > 0;}
+
+    // milliseconds until cost may be taken, 0 when it may be now
+    qint64 wait(double cost, qint64 now)
+    {
+        if(!isLimited())
+            return 0;
+
+        refill(now);
+
+        double missing = qMin(cost, m_burst) - m_tokens;
+        if(missing <= 0)
+            return 0;
+
+        return qMax(qint64(1), qint64(missing * 1000.0 / m_rate) + 1);
+    }
+
+    void take(double cost, qint64 now)
+    {
+        if(!isLimited())
+            return;
+
+        refill(now);
+        // costs above the burst go into debt, bounded by -burst
+        m_tokens = qMax(-m_burst, m_tokens - cost);
+    }
+
+private:
+    void refill(qint64 now)
+    {
+        m_tokens = qMin(m_burst, m_tokens + (now - m_updated) * m_rate / 1000.0);
+        m_updated = now;
+    }
+
+    double m_rate;
+    double m_burst;
+    double m_tokens;
+    qint64 m_updated;
+};
+
+#endif // TOKENBUCKET_H